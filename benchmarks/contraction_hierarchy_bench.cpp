@@ -0,0 +1,68 @@
+#include "contraction_hierarchy.h"
+#include "dijkstra_router.h"
+#include "grid_graph.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+// Среднее время запроса в микросекундах; веса путей дописываются в weights
+double RunQueries(const graph::RoutingEngine<double>& engine,
+                  const std::vector<std::pair<graph::VertexId, graph::VertexId>>& queries,
+                  std::vector<std::optional<double>>& weights) {
+    std::vector<graph::EdgeId> edges;
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& [from, to] : queries) {
+        weights.push_back(engine.BuildRoute(from, to, edges));
+    }
+    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / queries.size();
+}
+
+} // namespace
+
+// Статистика предобработки иерархии сжатия и время запросов против Дейкстры без кэша
+// Использование: contraction_hierarchy_bench [сторона решётки] [число запросов]
+int main(int argc, char* argv[]) {
+    const size_t side = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100;
+    const size_t query_count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000;
+    if (side == 0 || query_count == 0) {
+        std::cerr << "Usage: contraction_hierarchy_bench [grid_side] [query_count]\n"sv;
+        return 1;
+    }
+
+    const auto graph = benchmarks::MakeGridGraph(side);
+    const auto queries = benchmarks::MakeRandomQueries(graph.GetVertexCount(), query_count);
+
+    const graph::ContractionHierarchy<double> hierarchy(graph);
+    const auto& stats = hierarchy.GetStats();
+    // Кэш на одно дерево: случайные запросы почти не повторяют начальную вершину
+    const graph::DijkstraRouter<double> dijkstra(graph, 1);
+
+    std::vector<std::optional<double>> hierarchy_weights;
+    std::vector<std::optional<double>> dijkstra_weights;
+    const double hierarchy_time = RunQueries(hierarchy, queries, hierarchy_weights);
+    const double dijkstra_time = RunQueries(dijkstra, queries, dijkstra_weights);
+
+    std::cout << "vertices: "sv << graph.GetVertexCount() << ", edges: "sv << graph.GetEdgeCount() << '\n'
+              << "preprocessing: "sv << stats.preprocessing_time.count() << " ms\n"sv
+              << "shortcuts: "sv << stats.shortcut_count << '\n'
+              << "memory: "sv << stats.memory_usage / 1024 << " KiB\n"sv
+              << "query: "sv << hierarchy_time << " us, dijkstra: "sv << dijkstra_time << " us\n"sv;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        // Порядок сложения весов у движков разный, поэтому сравнение с допуском
+        if (hierarchy_weights[i].has_value() != dijkstra_weights[i].has_value()
+            || (hierarchy_weights[i] && std::abs(*hierarchy_weights[i] - *dijkstra_weights[i]) > 1e-9 * *dijkstra_weights[i])) {
+            std::cerr << "Hierarchy path weight differs from Dijkstra\n"sv;
+            return 1;
+        }
+    }
+}
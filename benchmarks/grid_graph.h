@@ -0,0 +1,48 @@
+#pragma once
+
+#include "graph.h"
+
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace benchmarks {
+
+// Решётка side x side со случайными весами рёбер в обе стороны: улицы города без маршрутов
+inline graph::DirectedWeightedGraph<double> MakeGridGraph(size_t side, unsigned seed = 1) {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> weight_distribution(1.0, 10.0);
+    graph::DirectedWeightedGraph<double> graph(side * side);
+    graph.ReserveEdges(4 * side * side);
+    const auto add_street = [&graph, &generator, &weight_distribution](graph::VertexId from, graph::VertexId to) {
+        graph.AddEdge({from, to, weight_distribution(generator)});
+        graph.AddEdge({to, from, weight_distribution(generator)});
+    };
+    for (size_t row = 0; row < side; ++row) {
+        for (size_t column = 0; column < side; ++column) {
+            const graph::VertexId vertex = row * side + column;
+            if (column + 1 < side) {
+                add_street(vertex, vertex + 1);
+            }
+            if (row + 1 < side) {
+                add_street(vertex, vertex + side);
+            }
+        }
+    }
+    graph.Freeze();
+    return graph;
+}
+
+inline std::vector<std::pair<graph::VertexId, graph::VertexId>> MakeRandomQueries(size_t vertex_count, size_t query_count, 
+                                                                                 unsigned seed = 2) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<graph::VertexId> vertex_distribution(0, vertex_count - 1);
+    std::vector<std::pair<graph::VertexId, graph::VertexId>> queries(query_count);
+    for (auto& [from, to] : queries) {
+        from = vertex_distribution(generator);
+        to = vertex_distribution(generator);
+    }
+    return queries;
+}
+
+} // namespace benchmarks
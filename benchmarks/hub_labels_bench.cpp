@@ -0,0 +1,87 @@
+#include "dijkstra_router.h"
+#include "grid_graph.h"
+#include "hub_labels.h"
+#include "parallel.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+// Среднее время запроса в микросекундах; веса путей дописываются в weights
+double RunQueries(const graph::RoutingEngine<double>& engine,
+                  const std::vector<std::pair<graph::VertexId, graph::VertexId>>& queries,
+                  std::vector<std::optional<double>>& weights) {
+    std::vector<graph::EdgeId> edges;
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& [from, to] : queries) {
+        weights.push_back(engine.BuildRoute(from, to, edges));
+    }
+    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / queries.size();
+}
+
+// Только веса, без восстановления пути; их сумма дописывается в checksum, чтобы запросы не выбросил оптимизатор
+double RunWeightQueries(const graph::HubLabels<double>& labels,
+                        const std::vector<std::pair<graph::VertexId, graph::VertexId>>& queries, double& checksum) {
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& [from, to] : queries) {
+        checksum += labels.ComputeWeight(from, to).value_or(0.0);
+    }
+    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / queries.size();
+}
+
+} // namespace
+
+// Статистика построения меток хабов и время запросов против Дейкстры без кэша
+// Использование: hub_labels_bench [сторона решётки] [число запросов] [число потоков]
+int main(int argc, char* argv[]) {
+    const size_t side = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100;
+    const size_t query_count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000;
+    const size_t threads_count = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : parallel::GetHardwareThreadsCount();
+    if (side == 0 || query_count == 0 || threads_count == 0) {
+        std::cerr << "Usage: hub_labels_bench [grid_side] [query_count] [threads_count]\n"sv;
+        return 1;
+    }
+
+    const auto graph = benchmarks::MakeGridGraph(side);
+    const auto queries = benchmarks::MakeRandomQueries(graph.GetVertexCount(), query_count);
+
+    const graph::HubLabels<double> labels(graph, threads_count);
+    const auto& stats = labels.GetStats();
+    // Кэш на одно дерево: случайные запросы почти не повторяют начальную вершину
+    const graph::DijkstraRouter<double> dijkstra(graph, 1);
+
+    std::vector<std::optional<double>> labels_weights;
+    std::vector<std::optional<double>> dijkstra_weights;
+    const double labels_time = RunQueries(labels, queries, labels_weights);
+    double weights_checksum = 0;
+    const double weight_time = RunWeightQueries(labels, queries, weights_checksum);
+    const double dijkstra_time = RunQueries(dijkstra, queries, dijkstra_weights);
+
+    std::cout << "vertices: "sv << graph.GetVertexCount() << ", edges: "sv << graph.GetEdgeCount()
+              << ", threads: "sv << threads_count << '\n'
+              << "preprocessing: "sv << stats.preprocessing_time.count() << " ms\n"sv
+              << "label entries: "sv << stats.label_entry_count << " ("sv
+              << double(stats.label_entry_count) / graph.GetVertexCount() << " per vertex)\n"sv
+              << "memory: "sv << stats.memory_usage / 1024 << " KiB\n"sv
+              << "query: "sv << labels_time << " us, weight only: "sv << weight_time
+              << " us, dijkstra: "sv << dijkstra_time << " us\n"sv
+              << "weights checksum: "sv << weights_checksum << '\n';
+    for (size_t i = 0; i < queries.size(); ++i) {
+        // Порядок сложения весов у движков разный, поэтому сравнение с допуском
+        if (labels_weights[i].has_value() != dijkstra_weights[i].has_value()
+            || (labels_weights[i] && std::abs(*labels_weights[i] - *dijkstra_weights[i]) > 1e-9 * *dijkstra_weights[i])) {
+            std::cerr << "Hub labels path weight differs from Dijkstra\n"sv;
+            return 1;
+        }
+    }
+}
@@ -0,0 +1,264 @@
+#include "json_reader.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+constexpr size_t QUERIES_PER_STEP = 200;
+constexpr double TIME_TOLERANCE = 1e-6;
+
+bool AreTimesEqual(double lhs, double rhs) {
+    return std::abs(lhs - rhs) <= TIME_TOLERANCE * std::max(1.0, std::abs(rhs));
+}
+
+bool ArePathsEqual(const std::optional<transport::PathInfo>& lhs, const std::optional<transport::PathInfo>& rhs) {
+    return lhs.has_value() == rhs.has_value() && (!lhs || AreTimesEqual(lhs->total_time, rhs->total_time));
+}
+
+// Время пути должно складываться из его элементов
+bool IsPathConsistent(const transport::PathInfo& path_info) {
+    double items_time = 0;
+    for (const auto& item : path_info.items) {
+        items_time += item.weight + path_info.bus_wait_time;
+    }
+    return AreTimesEqual(items_time, path_info.total_time);
+}
+
+class IncrementalRouterCheck {
+public:
+    IncrementalRouterCheck(const JsonReader& reader, transport::TransportCatalogue& catalogue, unsigned seed)
+        : reader_(reader)
+        , catalogue_(catalogue)
+        , generator_(seed) {
+        reader_.FillTransportRouter(router_);
+        router_.UploadTransportData(catalogue_);
+        for (const auto [stop_name, stop] : catalogue_.GetAllStops()) {
+            stops_.emplace_back(stop_name);
+        }
+        for (const auto [route_name, route] : catalogue_.GetAllRoutes()) {
+            buses_.emplace_back(route_name);
+        }
+    }
+
+    // Случайное изменение каталога, применённое к маршрутизатору инкрементально,
+    // и сравнение ответов со свежепостроенным маршрутизатором. Время изменения каталога
+    // не входит ни в один замер, а первый запрос входит в оба: движки, перестраивающиеся
+    // лениво, платят за перестройку именно в нём
+    void RunStep(size_t step) {
+        switch (generator_() % 4) {
+            case 0:
+                RemoveRandomRoute();
+                break;
+            case 1:
+                AddRandomRoute("New bus "s + std::to_string(step));
+                break;
+            case 2:
+                AddRandomRoute(buses_.empty() ? "New bus "s + std::to_string(step) : PickBus());
+                break;
+            default:
+                ChangeRandomDistance();
+                break;
+        }
+        const std::string& first_stop_from = PickStop();
+        const std::string& first_stop_to = PickStop();
+        const auto start = std::chrono::steady_clock::now();
+        ApplyPendingUpdates();
+        router_.BuildPath(first_stop_from, first_stop_to);
+        const auto updated = std::chrono::steady_clock::now();
+        transport::TransportRouter rebuilt_router;
+        reader_.FillTransportRouter(rebuilt_router);
+        rebuilt_router.UploadTransportData(catalogue_);
+        rebuilt_router.BuildPath(first_stop_from, first_stop_to);
+        const auto rebuilt = std::chrono::steady_clock::now();
+        update_time_ += updated - start;
+        rebuild_time_ += rebuilt - updated;
+
+        for (size_t query = 0; query < QUERIES_PER_STEP; ++query) {
+            const std::string& stop_from = PickStop();
+            const std::string& stop_to = PickStop();
+            const auto path_info = router_.BuildPath(stop_from, stop_to);
+            if (!ArePathsEqual(path_info, rebuilt_router.BuildPath(stop_from, stop_to))
+                || (path_info && !IsPathConsistent(*path_info))) {
+                ReportMismatch("step "s + std::to_string(step) + ": "s + stop_from + " -> "s + stop_to);
+            }
+        }
+    }
+
+    // Снимок маршрутизатора после всех обновлений должен отвечать так же, как сам маршрутизатор
+    void CheckSnapshot(const std::filesystem::path& path) {
+        router_.SaveSnapshot(catalogue_, path);
+        transport::TransportRouter loaded_router;
+        loaded_router.LoadSnapshot(catalogue_, path);
+        for (size_t query = 0; query < QUERIES_PER_STEP; ++query) {
+            const std::string& stop_from = PickStop();
+            const std::string& stop_to = PickStop();
+            if (!ArePathsEqual(router_.BuildPath(stop_from, stop_to), loaded_router.BuildPath(stop_from, stop_to))) {
+                ReportMismatch("snapshot: "s + stop_from + " -> "s + stop_to);
+            }
+        }
+        std::filesystem::remove(path);
+    }
+
+    size_t GetMismatchCount() const {
+        return mismatch_count_;
+    }
+
+    std::chrono::duration<double, std::milli> GetUpdateTime() const {
+        return update_time_;
+    }
+
+    std::chrono::duration<double, std::milli> GetRebuildTime() const {
+        return rebuild_time_;
+    }
+
+private:
+    static constexpr size_t MAX_REPORTED_MISMATCHES = 5;
+
+    const std::string& PickStop() {
+        return stops_[generator_() % stops_.size()];
+    }
+
+    const std::string& PickBus() {
+        return buses_[generator_() % buses_.size()];
+    }
+
+    // Изменения каталога одного шага доходят до маршрутизатора одним набором вызовов
+    void ApplyPendingUpdates() {
+        const std::vector<std::string_view> buses(pending_buses_.begin(), pending_buses_.end());
+        const std::vector<std::pair<std::string_view, std::string_view>> stop_pairs(pending_stop_pairs_.begin(),
+                                                                                    pending_stop_pairs_.end());
+        router_.UpdateRoutesAndDistances(catalogue_, buses, stop_pairs);
+        pending_stop_pairs_.clear();
+        pending_buses_.clear();
+    }
+
+    void RemoveRandomRoute() {
+        if (buses_.empty()) {
+            return;
+        }
+        const std::string bus = PickBus();
+        catalogue_.RemoveRoute(bus);
+        pending_buses_.push_back(bus);
+    }
+
+    // Новый маршрут или замена существующего с тем же именем; недостающие расстояния добавляются
+    void AddRandomRoute(const std::string& bus) {
+        const size_t stop_count = 2 + generator_() % 6;
+        std::vector<std::string> route_stops;
+        for (size_t i = 0; i < stop_count; ++i) {
+            route_stops.push_back(PickStop());
+        }
+        const bool is_roundtrip = generator_() % 2;
+        if (is_roundtrip) {
+            route_stops.push_back(route_stops.front());
+        }
+        for (size_t i = 1; i < route_stops.size(); ++i) {
+            AddMissingDistance(route_stops[i - 1], route_stops[i]);
+        }
+        const bool is_new_bus = !catalogue_.GetRoute(bus);
+        catalogue_.AddRoute(bus, route_stops, is_roundtrip);
+        pending_buses_.push_back(bus);
+        if (is_new_bus) {
+            buses_.push_back(bus);
+        }
+    }
+
+    void AddMissingDistance(std::string_view stop_from, std::string_view stop_to) {
+        if (catalogue_.GetRoadDistances().Find(catalogue_.GetStop(stop_from)->id, catalogue_.GetStop(stop_to)->id)) {
+            return;
+        }
+        catalogue_.AddDistance(stop_from, stop_to, 300 + generator_() % 5000);
+        pending_stop_pairs_.emplace_back(stop_from, stop_to);
+    }
+
+    // Расстояние между соседними остановками существующего маршрута меняется в 0,2–2,2 раза
+    void ChangeRandomDistance() {
+        if (buses_.empty()) {
+            return;
+        }
+        const transport::Route* route = catalogue_.GetRoute(PickBus());
+        if (!route || route->stops.size() < 2) {
+            return;
+        }
+        const size_t index = generator_() % (route->stops.size() - 1);
+        const std::string stop_from(catalogue_.GetStop(route->stops[index]).name);
+        const std::string stop_to(catalogue_.GetStop(route->stops[index + 1]).name);
+        const double factor = 0.2 + (generator_() % 100) / 50.0;
+        const int distance = std::max(1, static_cast<int>(catalogue_.GetDistance(stop_from, stop_to) * factor));
+        catalogue_.AddDistance(stop_from, stop_to, distance);
+        pending_stop_pairs_.emplace_back(stop_from, stop_to);
+    }
+
+    void ReportMismatch(const std::string& description) {
+        if (mismatch_count_++ < MAX_REPORTED_MISMATCHES) {
+            std::cerr << "Mismatch at "sv << description << '\n';
+        }
+    }
+
+    const JsonReader& reader_;
+    transport::TransportCatalogue& catalogue_;
+    transport::TransportRouter router_;
+    std::mt19937 generator_;
+    std::vector<std::string> stops_;
+    std::vector<std::string> buses_;
+    std::vector<std::pair<std::string, std::string>> pending_stop_pairs_;
+    std::vector<std::string> pending_buses_;
+    size_t mismatch_count_ = 0;
+    std::chrono::duration<double, std::milli> update_time_{0};
+    std::chrono::duration<double, std::milli> rebuild_time_{0};
+};
+
+} // namespace
+
+// Проверка равносильности инкрементальных обновлений маршрутизатора полной перестройке:
+// случайные AddRoute/RemoveRoute/AddDistance с UpdateRoutesAndDistances, после каждого
+// шага ответы на случайные запросы сравниваются со свежепостроенным маршрутизатором
+// Использование: incremental_router_check <входной JSON с base_requests и routing_settings> [seed] [число шагов]
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 4) {
+        std::cerr << "Usage: incremental_router_check <input.json> [seed] [steps]\n"sv;
+        return 1;
+    }
+    const unsigned seed = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1;
+    const size_t step_count = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 100;
+    std::ifstream input(argv[1]);
+    if (!input || step_count == 0) {
+        std::cerr << "Usage: incremental_router_check <input.json> [seed] [steps]\n"sv;
+        return 1;
+    }
+
+    JsonReader reader(input);
+    transport::TransportCatalogue catalogue;
+    reader.FillCatalogue(catalogue);
+    if (catalogue.GetAllStops().empty()) {
+        std::cerr << "Input has no stops\n"sv;
+        return 1;
+    }
+
+    IncrementalRouterCheck check(reader, catalogue, seed);
+    for (size_t step = 0; step < step_count; ++step) {
+        check.RunStep(step);
+    }
+    check.CheckSnapshot(std::filesystem::temp_directory_path() / "incremental_router_check.bin");
+
+    std::cout << "mismatches: "sv << check.GetMismatchCount() << '\n'
+              << "update: "sv << check.GetUpdateTime().count() / step_count << " ms, rebuild: "sv
+              << check.GetRebuildTime().count() / step_count << " ms per step\n"sv;
+    return check.GetMismatchCount() == 0 ? 0 : 1;
+}
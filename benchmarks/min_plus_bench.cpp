@@ -0,0 +1,92 @@
+#include "min_plus.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string_view>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+using RelaxRowFunction = void (*)(double, const double*, const uint32_t*, double*, uint32_t*, size_t);
+
+struct Table {
+    std::vector<double> weights;
+    std::vector<uint32_t> prev_edges;
+};
+
+// Случайная таблица весов n x n, где примерно пятая часть пар недостижима
+Table MakeRandomTable(size_t vertex_count) {
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> weight_distribution(0.0, 100.0);
+    Table table;
+    table.weights.resize(vertex_count * vertex_count);
+    table.prev_edges.resize(vertex_count * vertex_count);
+    for (size_t i = 0; i < table.weights.size(); ++i) {
+        table.weights[i] = generator() % 5 ? weight_distribution(generator) : std::numeric_limits<double>::infinity();
+        table.prev_edges[i] = static_cast<uint32_t>(generator());
+    }
+    return table;
+}
+
+// Релаксация Флойда–Уоршелла через первые through_count вершин; возвращает время в секундах
+double RunFloydWarshall(Table& table, size_t vertex_count, size_t through_count, RelaxRowFunction relax_row) {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t through = 0; through < through_count; ++through) {
+        const double* weights_through = table.weights.data() + through * vertex_count;
+        const uint32_t* prev_edges_through = table.prev_edges.data() + through * vertex_count;
+        for (size_t from = 0; from < vertex_count; ++from) {
+            if (from == through) {
+                continue;
+            }
+            double* weights_from = table.weights.data() + from * vertex_count;
+            relax_row(weights_from[through], weights_through, prev_edges_through,
+                      weights_from, table.prev_edges.data() + from * vertex_count, vertex_count);
+        }
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::string_view GetInstructionSetName(graph::InstructionSet instruction_set) {
+    switch (instruction_set) {
+        case graph::InstructionSet::SSE2:
+            return "sse2"sv;
+        case graph::InstructionSet::AVX2:
+            return "avx2"sv;
+        default:
+            return "scalar"sv;
+    }
+}
+
+} // namespace
+
+// Сравнивает векторное ядро min-plus с простым циклом на одной и той же таблице
+// Использование: min_plus_bench [число вершин] [число промежуточных вершин]
+int main(int argc, char* argv[]) {
+    const size_t vertex_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    const size_t through_count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200;
+    if (vertex_count == 0 || through_count > vertex_count) {
+        std::cerr << "Usage: min_plus_bench [vertex_count] [through_count <= vertex_count]\n"sv;
+        return 1;
+    }
+
+    const Table source_table = MakeRandomTable(vertex_count);
+    Table scalar_table = source_table;
+    Table kernel_table = source_table;
+    const double scalar_time = RunFloydWarshall(scalar_table, vertex_count, through_count, graph::RelaxRowMinPlusScalar);
+    const double kernel_time = RunFloydWarshall(kernel_table, vertex_count, through_count, graph::RelaxRowMinPlus);
+
+    std::cout << "vertices: "sv << vertex_count << ", through: "sv << through_count << '\n'
+              << "scalar: "sv << scalar_time << " s\n"sv
+              << GetInstructionSetName(graph::GetMinPlusInstructionSet()) << ": "sv << kernel_time << " s\n"sv
+              << "speedup: "sv << scalar_time / kernel_time << '\n';
+    if (scalar_table.weights != kernel_table.weights || scalar_table.prev_edges != kernel_table.prev_edges) {
+        std::cerr << "Kernel result differs from the scalar loop\n"sv;
+        return 1;
+    }
+}
@@ -0,0 +1,131 @@
+#include "json_reader.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+size_t allocation_count = 0;
+
+} // namespace
+
+// Счётчик выделений памяти для всей программы
+void* operator new(size_t size) {
+    ++allocation_count;
+    if (void* pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+namespace {
+
+struct QueriesResult {
+    double allocations_per_query = 0;
+    double time_per_query = 0;
+    double checksum = 0;
+};
+
+// Запросы без общего буфера: каждый путь возвращается новым PathInfo
+QueriesResult RunReturningQueries(const transport::TransportRouter& router,
+                                  const std::vector<std::pair<std::string_view, std::string_view>>& queries) {
+    QueriesResult result;
+    const size_t start_allocation_count = allocation_count;
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& [stop_from, stop_to] : queries) {
+        if (const auto path_info = router.BuildPath(stop_from, stop_to)) {
+            result.checksum += path_info->total_time + path_info->items.size();
+        }
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    result.allocations_per_query = double(allocation_count - start_allocation_count) / queries.size();
+    result.time_per_query = elapsed.count() / queries.size();
+    return result;
+}
+
+// Запросы с общим буфером пути, как в JsonReader::PrintRequestsResults
+QueriesResult RunBufferQueries(const transport::TransportRouter& router,
+                               const std::vector<std::pair<std::string_view, std::string_view>>& queries) {
+    QueriesResult result;
+    transport::PathInfo path_info;
+    const size_t start_allocation_count = allocation_count;
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& [stop_from, stop_to] : queries) {
+        if (router.BuildPath(stop_from, stop_to, path_info)) {
+            result.checksum += path_info.total_time + path_info.items.size();
+        }
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    result.allocations_per_query = double(allocation_count - start_allocation_count) / queries.size();
+    result.time_per_query = elapsed.count() / queries.size();
+    return result;
+}
+
+void PrintResult(std::string_view name, const QueriesResult& result) {
+    std::cout << name << ": "sv << result.allocations_per_query << " allocations, "sv
+              << result.time_per_query << " ns per query (checksum "sv << result.checksum << ")\n"sv;
+}
+
+} // namespace
+
+// Выделения памяти на запрос Route с общим буфером пути и без него
+// Использование: route_allocations_bench <входной JSON с base_requests и routing_settings> [число запросов]
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: route_allocations_bench <input.json> [query_count]\n"sv;
+        return 1;
+    }
+    const size_t query_count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000;
+    std::ifstream input(argv[1]);
+    if (!input || query_count == 0) {
+        std::cerr << "Usage: route_allocations_bench <input.json> [query_count]\n"sv;
+        return 1;
+    }
+
+    JsonReader reader(input);
+    transport::TransportCatalogue catalogue;
+    reader.FillCatalogue(catalogue);
+    transport::TransportRouter router;
+    reader.FillTransportRouter(router);
+    router.UploadTransportData(catalogue);
+
+    std::vector<std::string_view> stops;
+    for (const auto [stop_name, stop] : catalogue.GetAllStops()) {
+        stops.push_back(stop_name);
+    }
+    if (stops.empty()) {
+        std::cerr << "Input has no stops\n"sv;
+        return 1;
+    }
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<size_t> stop_distribution(0, stops.size() - 1);
+    std::vector<std::pair<std::string_view, std::string_view>> queries(query_count);
+    for (auto& [stop_from, stop_to] : queries) {
+        stop_from = stops[stop_distribution(generator)];
+        stop_to = stops[stop_distribution(generator)];
+    }
+
+    // Прогрев: кэши движков и буферы заполняются до замеров
+    RunBufferQueries(router, queries);
+    PrintResult("returning PathInfo"sv, RunReturningQueries(router, queries));
+    PrintResult("shared PathInfo"sv, RunBufferQueries(router, queries));
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+template <typename Weight>
+class AStarRouter final : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    // Нижняя оценка веса пути от vertex до target; должна быть согласованной,
+    // иначе найденный маршрут может оказаться не кратчайшим
+    using Heuristic = std::function<Weight(VertexId vertex, VertexId target)>;
+
+    AStarRouter(const Graph& graph, Heuristic heuristic);
+
+    using RoutingEngine<Weight>::BuildRoute;
+    std::optional<Weight> BuildRoute(VertexId from, VertexId to, std::vector<EdgeId>& edges) const override;
+    // Строка матрицы — один поиск Дейкстры без оценки, пока не найдены все targets
+    WeightsMatrix<Weight> BuildWeightsMatrix(const std::vector<VertexId>& sources,
+                                             const std::vector<VertexId>& targets) const override;
+    // Предобработки нет: проверяются веса новых рёбер, а буферы поиска растут вместе с графом.
+    // Оценка должна оставаться согласованной и для изменённого графа
+    bool UpdateEdges(const std::vector<EdgeId>& added_edges, const std::vector<EdgeId>& removed_edges) override;
+
+private:
+    void ResetSearch() const;
+
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight UNREACHABLE_WEIGHT = std::numeric_limits<Weight>::has_infinity
+                                                 ? std::numeric_limits<Weight>::infinity()
+                                                 : std::numeric_limits<Weight>::max() / 2;
+
+    const Graph& graph_;
+    Heuristic heuristic_;
+
+    mutable std::mutex search_mutex_;
+    mutable std::vector<Weight> weights_;
+    mutable std::vector<Weight> estimates_;
+    mutable std::vector<EdgeId> prev_edges_;
+    mutable std::vector<VertexId> touched_;
+    mutable MinQueue<std::tuple<Weight, Weight, VertexId>> route_queue_;
+    mutable MinQueue<std::pair<Weight, VertexId>> matrix_queue_;
+};
+
+template <typename Weight>
+AStarRouter<Weight>::AStarRouter(const Graph& graph, Heuristic heuristic)
+    : graph_(graph)
+    , heuristic_(std::move(heuristic))
+    , weights_(graph.GetVertexCount(), UNREACHABLE_WEIGHT)
+    , estimates_(graph.GetVertexCount(), ZERO_WEIGHT)
+    , prev_edges_(graph.GetVertexCount(), NO_EDGE)
+{
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+bool AStarRouter<Weight>::UpdateEdges(const std::vector<EdgeId>& added_edges,
+                                      [[maybe_unused]] const std::vector<EdgeId>& removed_edges) {
+    for (const EdgeId edge_id : added_edges) {
+        if (graph_.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+    std::lock_guard guard(search_mutex_);
+    const size_t vertex_count = graph_.GetVertexCount();
+    weights_.resize(vertex_count, UNREACHABLE_WEIGHT);
+    estimates_.resize(vertex_count, ZERO_WEIGHT);
+    prev_edges_.resize(vertex_count, NO_EDGE);
+    return true;
+}
+
+template <typename Weight>
+std::optional<Weight> AStarRouter<Weight>::BuildRoute(VertexId from, VertexId to, std::vector<EdgeId>& edges) const {
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    edges.clear();
+    std::lock_guard guard(search_mutex_);
+    ResetSearch();
+
+    auto& queue = route_queue_;
+
+    weights_[from] = ZERO_WEIGHT;
+    estimates_[from] = heuristic_(from, to);
+    touched_.push_back(from);
+    queue.push({estimates_[from], ZERO_WEIGHT, from});
+    while (!queue.empty()) {
+        const auto [estimate, weight, vertex] = queue.top();
+        queue.pop();
+        if (weights_[vertex] < weight) {
+            continue;
+        }
+        if (vertex == to) {
+            break;
+        }
+        graph_.ForEachIncidentEdge(vertex, [&, weight = weight](EdgeId edge_id, VertexId edge_to, Weight edge_weight) {
+            const Weight candidate_weight = weight + edge_weight;
+            Weight& weight_to = weights_[edge_to];
+            if (candidate_weight < weight_to) {
+                if (weight_to == UNREACHABLE_WEIGHT) {
+                    touched_.push_back(edge_to);
+                    estimates_[edge_to] = heuristic_(edge_to, to);
+                }
+                weight_to = candidate_weight;
+                prev_edges_[edge_to] = edge_id;
+                queue.push({candidate_weight + estimates_[edge_to], candidate_weight, edge_to});
+            }
+        });
+    }
+    if (weights_[to] == UNREACHABLE_WEIGHT) {
+        return std::nullopt;
+    }
+
+    for (EdgeId edge_id = prev_edges_[to]; edge_id != NO_EDGE; edge_id = prev_edges_[graph_.GetEdge(edge_id).from]) {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return weights_[to];
+}
+
+template <typename Weight>
+WeightsMatrix<Weight> AStarRouter<Weight>::BuildWeightsMatrix(const std::vector<VertexId>& sources,
+                                                              const std::vector<VertexId>& targets) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    std::vector<bool> is_target(vertex_count, false);
+    size_t distinct_target_count = 0;
+    for (const VertexId target : targets) {
+        if (target >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        if (!is_target[target]) {
+            is_target[target] = true;
+            ++distinct_target_count;
+        }
+    }
+
+    WeightsMatrix<Weight> matrix(sources.size(), std::vector<std::optional<Weight>>(targets.size()));
+    std::lock_guard guard(search_mutex_);
+    for (size_t source_index = 0; source_index < sources.size(); ++source_index) {
+        const VertexId source = sources[source_index];
+        if (source >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        ResetSearch();
+
+        auto& queue = matrix_queue_;
+
+        weights_[source] = ZERO_WEIGHT;
+        touched_.push_back(source);
+        queue.push({ZERO_WEIGHT, source});
+        size_t remaining_target_count = distinct_target_count;
+        while (!queue.empty() && remaining_target_count > 0) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weights_[vertex] < weight) {
+                continue;
+            }
+            if (is_target[vertex]) {
+                --remaining_target_count;
+            }
+            graph_.ForEachIncidentEdge(vertex, [&, weight = weight](EdgeId edge_id, VertexId edge_to, Weight edge_weight) {
+                const Weight candidate_weight = weight + edge_weight;
+                Weight& weight_to = weights_[edge_to];
+                if (candidate_weight < weight_to) {
+                    if (weight_to == UNREACHABLE_WEIGHT) {
+                        touched_.push_back(edge_to);
+                    }
+                    weight_to = candidate_weight;
+                    prev_edges_[edge_to] = edge_id;
+                    queue.push({candidate_weight, edge_to});
+                }
+            });
+        }
+        for (size_t target_index = 0; target_index < targets.size(); ++target_index) {
+            if (weights_[targets[target_index]] != UNREACHABLE_WEIGHT) {
+                matrix[source_index][target_index] = weights_[targets[target_index]];
+            }
+        }
+    }
+    return matrix;
+}
+
+template <typename Weight>
+void AStarRouter<Weight>::ResetSearch() const {
+    for (const VertexId vertex : touched_) {
+        weights_[vertex] = UNREACHABLE_WEIGHT;
+        prev_edges_[vertex] = NO_EDGE;
+    }
+    touched_.clear();
+    route_queue_.clear();
+    matrix_queue_.clear();
+}
+
+}  // namespace graph
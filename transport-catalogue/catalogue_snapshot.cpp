@@ -0,0 +1,77 @@
+#include "catalogue_snapshot.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace transport {
+
+CatalogueSnapshot::CatalogueSnapshot(const TransportCatalogue& catalogue)
+    : catalogue_(&catalogue) {
+    const auto by_name = [](const auto* lhs, const auto* rhs) {
+        return lhs->name < rhs->name;
+    };
+    for (const auto [route_name, route] : catalogue.GetAllRoutes()) {
+        sorted_routes_.push_back(route);
+    }
+    std::sort(sorted_routes_.begin(), sorted_routes_.end(), by_name);
+    for (const auto [stop_name, stop] : catalogue.GetAllStops()) {
+        sorted_stops_.push_back(stop);
+    }
+    std::sort(sorted_stops_.begin(), sorted_stops_.end(), by_name);
+
+    // Маршруты перебираются по именам, поэтому списки автобусов остановок получаются
+    // отсортированными без отдельной сортировки; повтор остановки в маршруте отсекается
+    // по номеру последнего записавшего её маршрута
+    const size_t stop_count = catalogue.GetStopCount();
+    constexpr uint32_t NO_ROUTE = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> last_route_index(stop_count, NO_ROUTE);
+    bus_offsets_.assign(stop_count + 1, 0);
+    for (uint32_t route_index = 0; route_index < sorted_routes_.size(); ++route_index) {
+        for (const StopId stop_id : sorted_routes_[route_index]->stops) {
+            if (last_route_index[stop_id] != route_index) {
+                last_route_index[stop_id] = route_index;
+                ++bus_offsets_[stop_id + 1];
+            }
+        }
+    }
+    for (size_t stop_id = 0; stop_id < stop_count; ++stop_id) {
+        bus_offsets_[stop_id + 1] += bus_offsets_[stop_id];
+    }
+    buses_.resize(bus_offsets_[stop_count]);
+    std::vector<uint32_t> positions(bus_offsets_.begin(), bus_offsets_.end() - 1);
+    std::fill(last_route_index.begin(), last_route_index.end(), NO_ROUTE);
+    for (uint32_t route_index = 0; route_index < sorted_routes_.size(); ++route_index) {
+        for (const StopId stop_id : sorted_routes_[route_index]->stops) {
+            if (last_route_index[stop_id] != route_index) {
+                last_route_index[stop_id] = route_index;
+                buses_[positions[stop_id]++] = sorted_routes_[route_index]->name;
+            }
+        }
+    }
+}
+
+const std::vector<const Route*>& CatalogueSnapshot::GetSortedRoutes() const {
+    return sorted_routes_;
+}
+
+const std::vector<const Stop*>& CatalogueSnapshot::GetSortedStops() const {
+    return sorted_stops_;
+}
+
+CatalogueSnapshot::BusesRange CatalogueSnapshot::GetBusesByStop(StopId stop_id) const {
+    // Остановка, добавленная после построения снимка, ещё не входит ни в один маршрут снимка
+    if (size_t{stop_id} + 1 >= bus_offsets_.size()) {
+        return {buses_.end(), buses_.end()};
+    }
+    return {buses_.begin() + bus_offsets_[stop_id], buses_.begin() + bus_offsets_[stop_id + 1]};
+}
+
+std::optional<CatalogueSnapshot::BusesRange> CatalogueSnapshot::GetBusesByStop(std::string_view stop_name) const {
+    const Stop* stop = catalogue_->GetStop(stop_name);
+    if (!stop) {
+        return std::nullopt;
+    }
+    return GetBusesByStop(stop->id);
+}
+
+} // namespace transport
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "domain.h"
+#include "ranges.h"
+#include "transport_catalogue.h"
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace transport {
+
+// Неизменяемый снимок каталога для ответов на запросы: маршруты и остановки отсортированы
+// по именам, а автобусы каждой остановки лежат отсортированными подряд в общем массиве.
+// Хранит указатели в каталог и после его изменения строится заново
+class CatalogueSnapshot {
+public:
+    using BusesRange = ranges::Range<std::vector<std::string_view>::const_iterator>;
+
+    explicit CatalogueSnapshot(const TransportCatalogue& catalogue);
+
+    const std::vector<const Route*>& GetSortedRoutes() const;
+    const std::vector<const Stop*>& GetSortedStops() const;
+    // Для остановки, которой не было при построении снимка, — пустой диапазон
+    BusesRange GetBusesByStop(StopId stop_id) const;
+    // nullopt — такой остановки нет
+    std::optional<BusesRange> GetBusesByStop(std::string_view stop_name) const;
+
+private:
+    const TransportCatalogue* catalogue_;
+    std::vector<const Route*> sorted_routes_;
+    std::vector<const Stop*> sorted_stops_;
+    std::vector<uint32_t> bus_offsets_;
+    std::vector<std::string_view> buses_;
+};
+
+} // namespace transport
@@ -0,0 +1,535 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+template <typename Weight>
+class ContractionHierarchy final : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    struct Stats {
+        size_t shortcut_count = 0;
+        size_t memory_usage = 0;
+        std::chrono::milliseconds preprocessing_time{0};
+    };
+
+    explicit ContractionHierarchy(const Graph& graph);
+
+    using RoutingEngine<Weight>::BuildRoute;
+    std::optional<Weight> BuildRoute(VertexId from, VertexId to, std::vector<EdgeId>& edges) const override;
+    // Матрица по схеме с корзинами: по одному поиску вверх из каждой вершины sources и targets
+    WeightsMatrix<Weight> BuildWeightsMatrix(const std::vector<VertexId>& sources,
+                                             const std::vector<VertexId>& targets) const override;
+
+    const Stats& GetStats() const;
+
+private:
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+    static constexpr size_t PRIORITY_WITNESS_SETTLED_LIMIT = 30;
+    static constexpr size_t CONTRACTION_WITNESS_SETTLED_LIMIT = 300;
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight UNREACHABLE_WEIGHT = std::numeric_limits<Weight>::has_infinity
+                                                 ? std::numeric_limits<Weight>::infinity()
+                                                 : std::numeric_limits<Weight>::max() / 2;
+
+    // Исходные рёбра сохраняют свои EdgeId, шорткаты добавляются после них
+    struct HierarchyEdge {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        EdgeId first_child = NO_EDGE;
+        EdgeId second_child = NO_EDGE;
+    };
+
+    struct UpwardEdge {
+        VertexId to;
+        Weight weight;
+        EdgeId hierarchy_edge;
+    };
+
+    struct UpwardGraph {
+        std::vector<size_t> offsets;
+        std::vector<UpwardEdge> edges;
+    };
+
+    struct ContractionState {
+        std::vector<std::vector<EdgeId>> out_edges;
+        std::vector<std::vector<EdgeId>> in_edges;
+        std::vector<bool> contracted;
+        std::vector<int> contracted_neighbours;
+        std::vector<int> levels;
+        std::vector<Weight> witness_weights;
+        std::vector<VertexId> witness_touched;
+    };
+
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = MinQueue<QueueItem>;
+
+    struct SearchSpace {
+        std::vector<Weight> weights;
+        std::vector<EdgeId> parent_edges;
+        std::vector<VertexId> touched;
+        Queue queue;
+    };
+
+    void InitializeContractionState(const Graph& graph, ContractionState& state);
+    void RunWitnessSearch(ContractionState& state, VertexId source, VertexId excluded, Weight max_weight,
+                          size_t settled_limit) const;
+    std::vector<HierarchyEdge> FindShortcuts(ContractionState& state, VertexId vertex, size_t settled_limit) const;
+    int ComputePriority(ContractionState& state, VertexId vertex) const;
+    bool LinkEdge(ContractionState& state, EdgeId edge_id);
+    void AddShortcut(ContractionState& state, const HierarchyEdge& shortcut);
+    void ContractVertex(ContractionState& state, VertexId vertex);
+    void BuildUpwardGraphs(const ContractionState& state);
+
+    void SettleVertex(const UpwardGraph& upward_graph, const UpwardGraph& stalling_graph,
+                      SearchSpace& search_space, Queue& queue) const;
+    void RunUpwardSearch(const UpwardGraph& upward_graph, const UpwardGraph& stalling_graph,
+                         SearchSpace& search_space, VertexId from) const;
+    void UnpackEdge(EdgeId hierarchy_edge, std::vector<EdgeId>& edges) const;
+    static void ResetSearchSpace(SearchSpace& search_space);
+
+    std::vector<HierarchyEdge> edges_;
+    std::vector<size_t> ranks_;
+    UpwardGraph forward_graph_;
+    UpwardGraph backward_graph_;
+    Stats stats_;
+
+    mutable std::mutex search_mutex_;
+    mutable SearchSpace forward_search_;
+    mutable SearchSpace backward_search_;
+    mutable std::vector<EdgeId> hierarchy_edges_;
+    mutable std::vector<EdgeId> unpack_stack_;
+};
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph)
+    : ranks_(graph.GetVertexCount())
+{
+    const auto start_time = std::chrono::steady_clock::now();
+    const size_t vertex_count = graph.GetVertexCount();
+
+    ContractionState state;
+    InitializeContractionState(graph, state);
+
+    Queue queue;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        queue.push({ComputePriority(state, vertex), vertex});
+    }
+    size_t next_rank = 0;
+    while (!queue.empty()) {
+        const VertexId vertex = queue.top().second;
+        queue.pop();
+        if (state.contracted[vertex]) {
+            continue;
+        }
+        const int priority = ComputePriority(state, vertex);
+        if (!queue.empty() && priority > queue.top().first) {
+            queue.push({priority, vertex});
+            continue;
+        }
+        ContractVertex(state, vertex);
+        ranks_[vertex] = next_rank++;
+    }
+    BuildUpwardGraphs(state);
+
+    forward_search_ = {std::vector<Weight>(vertex_count, UNREACHABLE_WEIGHT), std::vector<EdgeId>(vertex_count, NO_EDGE), {}, {}};
+    backward_search_ = forward_search_;
+
+    stats_.shortcut_count = edges_.size() - graph.GetEdgeCount();
+    stats_.memory_usage = edges_.capacity() * sizeof(HierarchyEdge) + ranks_.capacity() * sizeof(size_t)
+                          + (forward_graph_.offsets.capacity() + backward_graph_.offsets.capacity()) * sizeof(size_t)
+                          + (forward_graph_.edges.capacity() + backward_graph_.edges.capacity()) * sizeof(UpwardEdge)
+                          + 2 * vertex_count * (sizeof(Weight) + sizeof(EdgeId));
+    stats_.preprocessing_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                std::chrono::steady_clock::now() - start_time);
+}
+
+template <typename Weight>
+std::optional<Weight> ContractionHierarchy<Weight>::BuildRoute(VertexId from, VertexId to, std::vector<EdgeId>& edges) const {
+    if (from >= ranks_.size() || to >= ranks_.size()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    edges.clear();
+    if (from == to) {
+        return ZERO_WEIGHT;
+    }
+    std::lock_guard guard(search_mutex_);
+    ResetSearchSpace(forward_search_);
+    ResetSearchSpace(backward_search_);
+
+    Queue& forward_queue = forward_search_.queue;
+    Queue& backward_queue = backward_search_.queue;
+    forward_search_.weights[from] = ZERO_WEIGHT;
+    forward_search_.touched.push_back(from);
+    forward_queue.push({ZERO_WEIGHT, from});
+    backward_search_.weights[to] = ZERO_WEIGHT;
+    backward_search_.touched.push_back(to);
+    backward_queue.push({ZERO_WEIGHT, to});
+
+    Weight best_weight = UNREACHABLE_WEIGHT;
+    std::optional<VertexId> meeting_vertex;
+    const auto update_best = [&](VertexId vertex) {
+        const Weight forward_weight = forward_search_.weights[vertex];
+        const Weight backward_weight = backward_search_.weights[vertex];
+        if (forward_weight != UNREACHABLE_WEIGHT && backward_weight != UNREACHABLE_WEIGHT
+            && forward_weight + backward_weight < best_weight) {
+            best_weight = forward_weight + backward_weight;
+            meeting_vertex = vertex;
+        }
+    };
+
+    while (!forward_queue.empty() || !backward_queue.empty()) {
+        if (!forward_queue.empty() && !(forward_queue.top().first < best_weight)) {
+            forward_queue.clear();
+        }
+        if (!backward_queue.empty() && !(backward_queue.top().first < best_weight)) {
+            backward_queue.clear();
+        }
+        const bool forward_step = !forward_queue.empty()
+                                  && (backward_queue.empty() || forward_queue.top().first <= backward_queue.top().first);
+        if (forward_step) {
+            update_best(forward_queue.top().second);
+            SettleVertex(forward_graph_, backward_graph_, forward_search_, forward_queue);
+        } else if (!backward_queue.empty()) {
+            update_best(backward_queue.top().second);
+            SettleVertex(backward_graph_, forward_graph_, backward_search_, backward_queue);
+        }
+    }
+    if (!meeting_vertex) {
+        return std::nullopt;
+    }
+
+    auto& hierarchy_edges = hierarchy_edges_;
+    hierarchy_edges.clear();
+    for (VertexId vertex = *meeting_vertex; vertex != from; vertex = edges_[hierarchy_edges.back()].from) {
+        hierarchy_edges.push_back(forward_search_.parent_edges[vertex]);
+    }
+    std::reverse(hierarchy_edges.begin(), hierarchy_edges.end());
+    for (VertexId vertex = *meeting_vertex; vertex != to; vertex = edges_[hierarchy_edges.back()].to) {
+        hierarchy_edges.push_back(backward_search_.parent_edges[vertex]);
+    }
+
+    for (const EdgeId hierarchy_edge : hierarchy_edges) {
+        UnpackEdge(hierarchy_edge, edges);
+    }
+    return best_weight;
+}
+
+template <typename Weight>
+WeightsMatrix<Weight> ContractionHierarchy<Weight>::BuildWeightsMatrix(const std::vector<VertexId>& sources,
+                                                                       const std::vector<VertexId>& targets) const {
+    const auto is_out_of_range = [this](VertexId vertex) {
+        return vertex >= ranks_.size();
+    };
+    if (std::any_of(sources.begin(), sources.end(), is_out_of_range)
+        || std::any_of(targets.begin(), targets.end(), is_out_of_range)) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    struct BucketEntry {
+        size_t target_index;
+        Weight weight;
+    };
+    std::vector<std::vector<BucketEntry>> buckets(ranks_.size());
+    WeightsMatrix<Weight> matrix(sources.size(), std::vector<std::optional<Weight>>(targets.size()));
+
+    std::lock_guard guard(search_mutex_);
+    for (size_t target_index = 0; target_index < targets.size(); ++target_index) {
+        RunUpwardSearch(backward_graph_, forward_graph_, backward_search_, targets[target_index]);
+        for (const VertexId vertex : backward_search_.touched) {
+            buckets[vertex].push_back({target_index, backward_search_.weights[vertex]});
+        }
+    }
+    for (size_t source_index = 0; source_index < sources.size(); ++source_index) {
+        RunUpwardSearch(forward_graph_, backward_graph_, forward_search_, sources[source_index]);
+        auto& row = matrix[source_index];
+        for (const VertexId vertex : forward_search_.touched) {
+            const Weight forward_weight = forward_search_.weights[vertex];
+            for (const BucketEntry& entry : buckets[vertex]) {
+                const Weight weight = forward_weight + entry.weight;
+                if (!row[entry.target_index] || weight < *row[entry.target_index]) {
+                    row[entry.target_index] = weight;
+                }
+            }
+        }
+    }
+    return matrix;
+}
+
+template <typename Weight>
+const typename ContractionHierarchy<Weight>::Stats& ContractionHierarchy<Weight>::GetStats() const {
+    return stats_;
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::InitializeContractionState(const Graph& graph, ContractionState& state) {
+    const size_t vertex_count = graph.GetVertexCount();
+    state.out_edges.resize(vertex_count);
+    state.in_edges.resize(vertex_count);
+    state.contracted.assign(vertex_count, false);
+    state.contracted_neighbours.assign(vertex_count, 0);
+    state.levels.assign(vertex_count, 0);
+    state.witness_weights.assign(vertex_count, UNREACHABLE_WEIGHT);
+
+    edges_.reserve(graph.GetEdgeCount());
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        edges_.push_back({edge.from, edge.to, edge.weight});
+    }
+    // Из параллельных рёбер в иерархию попадает только самое лёгкое, петли не нужны вовсе;
+    // удалённые из графа рёбра сохраняют свои EdgeId в edges_, но в иерархию не попадают
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        graph.ForEachIncidentEdge(vertex, [this, &state](EdgeId edge_id, VertexId to, Weight) {
+            if (edges_[edge_id].from != to) {
+                LinkEdge(state, edge_id);
+            }
+        });
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::RunWitnessSearch(ContractionState& state, VertexId source, VertexId excluded,
+                                                    Weight max_weight, size_t settled_limit) const {
+    Queue queue;
+    state.witness_weights[source] = ZERO_WEIGHT;
+    state.witness_touched.push_back(source);
+    queue.push({ZERO_WEIGHT, source});
+    size_t settled_count = 0;
+    while (!queue.empty() && settled_count < settled_limit) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (state.witness_weights[vertex] < weight) {
+            continue;
+        }
+        if (max_weight < weight) {
+            break;
+        }
+        ++settled_count;
+        for (const EdgeId edge_id : state.out_edges[vertex]) {
+            const HierarchyEdge& edge = edges_[edge_id];
+            if (edge.to == excluded || state.contracted[edge.to]) {
+                continue;
+            }
+            const Weight candidate_weight = weight + edge.weight;
+            Weight& witness_weight = state.witness_weights[edge.to];
+            if (candidate_weight < witness_weight) {
+                if (witness_weight == UNREACHABLE_WEIGHT) {
+                    state.witness_touched.push_back(edge.to);
+                }
+                witness_weight = candidate_weight;
+                queue.push({candidate_weight, edge.to});
+            }
+        }
+    }
+}
+
+template <typename Weight>
+std::vector<typename ContractionHierarchy<Weight>::HierarchyEdge>
+ContractionHierarchy<Weight>::FindShortcuts(ContractionState& state, VertexId vertex, size_t settled_limit) const {
+    std::vector<HierarchyEdge> shortcuts;
+    for (const EdgeId in_edge_id : state.in_edges[vertex]) {
+        const HierarchyEdge& in_edge = edges_[in_edge_id];
+        if (state.contracted[in_edge.from]) {
+            continue;
+        }
+        Weight max_weight = ZERO_WEIGHT;
+        for (const EdgeId out_edge_id : state.out_edges[vertex]) {
+            const HierarchyEdge& out_edge = edges_[out_edge_id];
+            if (!state.contracted[out_edge.to] && out_edge.to != in_edge.from) {
+                max_weight = std::max(max_weight, in_edge.weight + out_edge.weight);
+            }
+        }
+        RunWitnessSearch(state, in_edge.from, vertex, max_weight, settled_limit);
+        for (const EdgeId out_edge_id : state.out_edges[vertex]) {
+            const HierarchyEdge& out_edge = edges_[out_edge_id];
+            if (state.contracted[out_edge.to] || out_edge.to == in_edge.from) {
+                continue;
+            }
+            const Weight shortcut_weight = in_edge.weight + out_edge.weight;
+            if (shortcut_weight < state.witness_weights[out_edge.to]) {
+                shortcuts.push_back({in_edge.from, out_edge.to, shortcut_weight, in_edge_id, out_edge_id});
+            }
+        }
+        for (const VertexId touched : state.witness_touched) {
+            state.witness_weights[touched] = UNREACHABLE_WEIGHT;
+        }
+        state.witness_touched.clear();
+    }
+    return shortcuts;
+}
+
+template <typename Weight>
+int ContractionHierarchy<Weight>::ComputePriority(ContractionState& state, VertexId vertex) const {
+    int removed_edge_count = 0;
+    for (const EdgeId edge_id : state.in_edges[vertex]) {
+        removed_edge_count += state.contracted[edges_[edge_id].from] ? 0 : 1;
+    }
+    for (const EdgeId edge_id : state.out_edges[vertex]) {
+        removed_edge_count += state.contracted[edges_[edge_id].to] ? 0 : 1;
+    }
+    const int shortcut_count = static_cast<int>(FindShortcuts(state, vertex, PRIORITY_WITNESS_SETTLED_LIMIT).size());
+    return shortcut_count - removed_edge_count + state.contracted_neighbours[vertex] + state.levels[vertex];
+}
+
+template <typename Weight>
+bool ContractionHierarchy<Weight>::LinkEdge(ContractionState& state, EdgeId edge_id) {
+    const HierarchyEdge& edge = edges_[edge_id];
+    auto& out_edges = state.out_edges[edge.from];
+    const auto existing = std::find_if(out_edges.begin(), out_edges.end(), [&](EdgeId out_edge_id) {
+        return edges_[out_edge_id].to == edge.to;
+    });
+    if (existing == out_edges.end()) {
+        out_edges.push_back(edge_id);
+        state.in_edges[edge.to].push_back(edge_id);
+        return true;
+    }
+    if (!(edge.weight < edges_[*existing].weight)) {
+        return false;
+    }
+    auto& in_edges = state.in_edges[edge.to];
+    *std::find(in_edges.begin(), in_edges.end(), *existing) = edge_id;
+    *existing = edge_id;
+    return true;
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::AddShortcut(ContractionState& state, const HierarchyEdge& shortcut) {
+    edges_.push_back(shortcut);
+    if (!LinkEdge(state, edges_.size() - 1)) {
+        edges_.pop_back();
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::ContractVertex(ContractionState& state, VertexId vertex) {
+    for (const HierarchyEdge& shortcut : FindShortcuts(state, vertex, CONTRACTION_WITNESS_SETTLED_LIMIT)) {
+        AddShortcut(state, shortcut);
+    }
+    state.contracted[vertex] = true;
+    const auto update_neighbour = [&](VertexId neighbour) {
+        ++state.contracted_neighbours[neighbour];
+        state.levels[neighbour] = std::max(state.levels[neighbour], state.levels[vertex] + 1);
+    };
+    for (const EdgeId edge_id : state.in_edges[vertex]) {
+        update_neighbour(edges_[edge_id].from);
+    }
+    for (const EdgeId edge_id : state.out_edges[vertex]) {
+        update_neighbour(edges_[edge_id].to);
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::BuildUpwardGraphs(const ContractionState& state) {
+    const size_t vertex_count = ranks_.size();
+    std::vector<std::vector<UpwardEdge>> forward_edges(vertex_count);
+    std::vector<std::vector<UpwardEdge>> backward_edges(vertex_count);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        for (const EdgeId edge_id : state.out_edges[vertex]) {
+            const HierarchyEdge& edge = edges_[edge_id];
+            if (ranks_[edge.from] < ranks_[edge.to]) {
+                forward_edges[edge.from].push_back({edge.to, edge.weight, edge_id});
+            } else {
+                backward_edges[edge.to].push_back({edge.from, edge.weight, edge_id});
+            }
+        }
+    }
+    for (auto [upward_edges, upward_graph] : {std::pair{&forward_edges, &forward_graph_},
+                                              std::pair{&backward_edges, &backward_graph_}}) {
+        upward_graph->offsets.reserve(vertex_count + 1);
+        upward_graph->offsets.push_back(0);
+        for (const auto& vertex_edges : *upward_edges) {
+            upward_graph->edges.insert(upward_graph->edges.end(), vertex_edges.begin(), vertex_edges.end());
+            upward_graph->offsets.push_back(upward_graph->edges.size());
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::SettleVertex(const UpwardGraph& upward_graph, const UpwardGraph& stalling_graph,
+                                                SearchSpace& search_space, Queue& queue) const {
+    const auto [weight, vertex] = queue.top();
+    queue.pop();
+    if (search_space.weights[vertex] < weight) {
+        return;
+    }
+    // Stall-on-demand: если до вершины короче дойти сверху, её рёбра заведомо не нужны
+    for (size_t i = stalling_graph.offsets[vertex]; i < stalling_graph.offsets[vertex + 1]; ++i) {
+        const UpwardEdge& edge = stalling_graph.edges[i];
+        const Weight neighbour_weight = search_space.weights[edge.to];
+        if (neighbour_weight != UNREACHABLE_WEIGHT && neighbour_weight + edge.weight < weight) {
+            return;
+        }
+    }
+    for (size_t i = upward_graph.offsets[vertex]; i < upward_graph.offsets[vertex + 1]; ++i) {
+        const UpwardEdge& edge = upward_graph.edges[i];
+        const Weight candidate_weight = weight + edge.weight;
+        Weight& current_weight = search_space.weights[edge.to];
+        if (candidate_weight < current_weight) {
+            if (current_weight == UNREACHABLE_WEIGHT) {
+                search_space.touched.push_back(edge.to);
+            }
+            current_weight = candidate_weight;
+            search_space.parent_edges[edge.to] = edge.hierarchy_edge;
+            queue.push({candidate_weight, edge.to});
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::RunUpwardSearch(const UpwardGraph& upward_graph, const UpwardGraph& stalling_graph,
+                                                   SearchSpace& search_space, VertexId from) const {
+    ResetSearchSpace(search_space);
+    Queue& queue = search_space.queue;
+    search_space.weights[from] = ZERO_WEIGHT;
+    search_space.touched.push_back(from);
+    queue.push({ZERO_WEIGHT, from});
+    while (!queue.empty()) {
+        SettleVertex(upward_graph, stalling_graph, search_space, queue);
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::UnpackEdge(EdgeId hierarchy_edge, std::vector<EdgeId>& edges) const {
+    auto& stack = unpack_stack_;
+    stack.assign(1, hierarchy_edge);
+    while (!stack.empty()) {
+        const EdgeId edge_id = stack.back();
+        stack.pop_back();
+        const HierarchyEdge& edge = edges_[edge_id];
+        if (edge.first_child == NO_EDGE) {
+            edges.push_back(edge_id);
+        } else {
+            stack.push_back(edge.second_child);
+            stack.push_back(edge.first_child);
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::ResetSearchSpace(SearchSpace& search_space) {
+    for (const VertexId vertex : search_space.touched) {
+        search_space.weights[vertex] = UNREACHABLE_WEIGHT;
+        search_space.parent_edges[vertex] = NO_EDGE;
+    }
+    search_space.touched.clear();
+    search_space.queue.clear();
+}
+
+}  // namespace graph
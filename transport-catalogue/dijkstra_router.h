@@ -0,0 +1,204 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+template <typename Weight>
+class DijkstraRouter final : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    static constexpr size_t DEFAULT_CACHED_TREES_LIMIT = 64;
+
+    explicit DijkstraRouter(const Graph& graph, size_t cached_trees_limit = DEFAULT_CACHED_TREES_LIMIT);
+
+    using RoutingEngine<Weight>::BuildRoute;
+    std::optional<Weight> BuildRoute(VertexId from, VertexId to, std::vector<EdgeId>& edges) const override;
+    WeightsMatrix<Weight> BuildWeightsMatrix(const std::vector<VertexId>& sources,
+                                             const std::vector<VertexId>& targets) const override;
+    // Из кэша выбрасываются только деревья, которые изменение графа делает неверными
+    bool UpdateEdges(const std::vector<EdgeId>& added_edges, const std::vector<EdgeId>& removed_edges) override;
+
+private:
+    struct RouteInternalData {
+        Weight weight;
+        std::optional<EdgeId> prev_edge;
+    };
+    using ShortestPathTree = std::vector<std::optional<RouteInternalData>>;
+    using CachedTrees = std::list<std::pair<VertexId, ShortestPathTree>>;
+
+    void BuildShortestPathTree(VertexId from, ShortestPathTree& tree) const;
+    const ShortestPathTree& GetShortestPathTree(VertexId from) const;
+    bool IsTreeValid(const ShortestPathTree& tree, const std::vector<EdgeId>& added_edges,
+                     const std::vector<EdgeId>& removed_edges) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    const size_t cached_trees_limit_;
+    mutable std::mutex cache_mutex_;
+    mutable CachedTrees cached_trees_;
+    mutable std::unordered_map<VertexId, typename CachedTrees::iterator> cached_tree_by_vertex_;
+    mutable MinQueue<std::pair<Weight, VertexId>> queue_;
+};
+
+template <typename Weight>
+DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph, size_t cached_trees_limit)
+    : graph_(graph)
+    , cached_trees_limit_(std::max<size_t>(cached_trees_limit, 1))
+{
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<Weight> DijkstraRouter<Weight>::BuildRoute(VertexId from, VertexId to, std::vector<EdgeId>& edges) const {
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    edges.clear();
+    std::lock_guard guard(cache_mutex_);
+    const ShortestPathTree& tree = GetShortestPathTree(from);
+    if (!tree[to]) {
+        return std::nullopt;
+    }
+    const Weight weight = tree[to]->weight;
+    for (std::optional<EdgeId> edge_id = tree[to]->prev_edge;
+         edge_id;
+         edge_id = tree[graph_.GetEdge(*edge_id).from]->prev_edge)
+    {
+        edges.push_back(*edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return weight;
+}
+
+template <typename Weight>
+WeightsMatrix<Weight> DijkstraRouter<Weight>::BuildWeightsMatrix(const std::vector<VertexId>& sources,
+                                                                 const std::vector<VertexId>& targets) const {
+    for (const VertexId target : targets) {
+        if (target >= graph_.GetVertexCount()) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+    }
+    WeightsMatrix<Weight> matrix(sources.size(), std::vector<std::optional<Weight>>(targets.size()));
+    std::lock_guard guard(cache_mutex_);
+    for (size_t source_index = 0; source_index < sources.size(); ++source_index) {
+        if (sources[source_index] >= graph_.GetVertexCount()) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        // Одно дерево кратчайших путей отвечает на всю строку матрицы
+        const ShortestPathTree& tree = GetShortestPathTree(sources[source_index]);
+        for (size_t target_index = 0; target_index < targets.size(); ++target_index) {
+            if (const auto& route = tree[targets[target_index]]) {
+                matrix[source_index][target_index] = route->weight;
+            }
+        }
+    }
+    return matrix;
+}
+
+template <typename Weight>
+bool DijkstraRouter<Weight>::UpdateEdges(const std::vector<EdgeId>& added_edges, const std::vector<EdgeId>& removed_edges) {
+    for (const EdgeId edge_id : added_edges) {
+        if (graph_.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+    std::lock_guard guard(cache_mutex_);
+    for (auto it = cached_trees_.begin(); it != cached_trees_.end();) {
+        if (IsTreeValid(it->second, added_edges, removed_edges)) {
+            ++it;
+        } else {
+            cached_tree_by_vertex_.erase(it->first);
+            it = cached_trees_.erase(it);
+        }
+    }
+    return true;
+}
+
+template <typename Weight>
+bool DijkstraRouter<Weight>::IsTreeValid(const ShortestPathTree& tree, const std::vector<EdgeId>& added_edges,
+                                         const std::vector<EdgeId>& removed_edges) const {
+    if (tree.size() != graph_.GetVertexCount()) {
+        return false;
+    }
+    for (const EdgeId edge_id : removed_edges) {
+        const auto& route_to = tree[graph_.GetEdge(edge_id).to];
+        if (route_to && route_to->prev_edge == edge_id) {
+            return false;
+        }
+    }
+    for (const EdgeId edge_id : added_edges) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        const auto& route_from = tree[edge.from];
+        const auto& route_to = tree[edge.to];
+        if (route_from && (!route_to || route_from->weight + edge.weight < route_to->weight)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Weight>
+void DijkstraRouter<Weight>::BuildShortestPathTree(VertexId from, ShortestPathTree& tree) const {
+    auto& queue = queue_;
+    queue.clear();
+    tree.assign(graph_.GetVertexCount(), std::nullopt);
+    tree[from] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+    queue.push({ZERO_WEIGHT, from});
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (tree[vertex]->weight < weight) {
+            continue;
+        }
+        graph_.ForEachIncidentEdge(vertex, [&, weight = weight](EdgeId edge_id, VertexId to, Weight edge_weight) {
+            const Weight candidate_weight = weight + edge_weight;
+            auto& route_to = tree[to];
+            if (!route_to || candidate_weight < route_to->weight) {
+                route_to = RouteInternalData{candidate_weight, edge_id};
+                queue.push({candidate_weight, to});
+            }
+        });
+    }
+}
+
+template <typename Weight>
+const typename DijkstraRouter<Weight>::ShortestPathTree& DijkstraRouter<Weight>::GetShortestPathTree(VertexId from) const {
+    if (const auto it = cached_tree_by_vertex_.find(from); it != cached_tree_by_vertex_.end()) {
+        cached_trees_.splice(cached_trees_.begin(), cached_trees_, it->second);
+        return cached_trees_.front().second;
+    }
+    if (cached_trees_.size() == cached_trees_limit_) {
+        // Новое дерево строится на месте самого давнего, переиспользуя его память
+        auto node = cached_tree_by_vertex_.extract(cached_trees_.back().first);
+        cached_trees_.splice(cached_trees_.begin(), cached_trees_, node.mapped());
+        cached_trees_.front().first = from;
+        node.key() = from;
+        cached_tree_by_vertex_.insert(std::move(node));
+    } else {
+        cached_trees_.emplace_front(from, ShortestPathTree{});
+        cached_tree_by_vertex_[from] = cached_trees_.begin();
+    }
+    BuildShortestPathTree(from, cached_trees_.front().second);
+    return cached_trees_.front().second;
+}
+
+}  // namespace graph
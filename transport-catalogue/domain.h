@@ -2,20 +2,28 @@
 
 #include "geo.h"
 
-#include <string>
+#include <cstdint>
+#include <string_view>
 #include <vector>
 
 namespace transport {
+
+// Плотные номера остановок и маршрутов в каталоге, в порядке добавления
+using StopId = uint32_t;
+using RouteId = uint32_t;
     
+// Имена указывают в StringInterner каталога и живут, пока жив каталог
 struct Stop {
-    std::string name;
+    std::string_view name;
     geo::Coordinates coordinates;
+    StopId id = 0;
 };
 
 struct Route {
-    std::string name;
-    std::vector<std::string> stops;
+    std::string_view name;
+    std::vector<StopId> stops;
     bool is_roundtrip = false;
+    RouteId id = 0;
 };
  
 } // namespace transport
@@ -2,7 +2,10 @@
 
 #include "ranges.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdlib>
+#include <stdexcept>
 #include <vector>
 
 namespace graph {
@@ -21,39 +24,167 @@ template <typename Weight>
 class DirectedWeightedGraph {
 private:
     using IncidenceList = std::vector<EdgeId>;
-    using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
+    using IncidentEdgesRange = ranges::Range<const EdgeId*>;
 
 public:
     DirectedWeightedGraph() = default;
     explicit DirectedWeightedGraph(size_t vertex_count);
+    VertexId AddVertex();
     EdgeId AddEdge(const Edge<Weight>& edge);
+    // Резервирует место под edge_count рёбер всего, как std::vector::reserve
+    void ReserveEdges(size_t edge_count);
+    // Ребро пропадает из списка исходящих рёбер своей вершины, но его EdgeId остаётся занятым
+    void RemoveEdge(EdgeId edge_id);
+    // Из рёбер с общими началом и концом оставляет самое лёгкое, из равных — с меньшим EdgeId;
+    // остальные удаляются как в RemoveEdge. Возвращает число удалённых рёбер
+    size_t RemoveParallelEdges();
+
+    // Переводит граф в CSR-представление: исходящие рёбра вершины лежат подряд,
+    // а их концы и веса — в параллельных массивах; любое изменение графа возвращает
+    // его в обычное представление, после серии изменений граф можно заморозить снова
+    void Freeze();
+    bool IsFrozen() const;
 
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
     const Edge<Weight>& GetEdge(EdgeId edge_id) const;
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
 
+    // Вызывает function(edge_id, to, weight) для каждого исходящего из vertex ребра
+    template <typename Function>
+    void ForEachIncidentEdge(VertexId vertex, Function function) const;
+
 private:
+    void Thaw();
+
     std::vector<Edge<Weight>> edges_;
     std::vector<IncidenceList> incidence_lists_;
+
+    bool is_frozen_ = false;
+    std::vector<size_t> incidence_offsets_;
+    std::vector<EdgeId> incident_edges_;
+    std::vector<VertexId> incident_targets_;
+    std::vector<Weight> incident_weights_;
 };
 
+// Слабо связные компоненты графа без учёта удалённых рёбер: между вершинами
+// разных компонент пути нет ни в одну сторону. Компоненты нумеруются по
+// возрастанию их наименьшей вершины
+struct Components {
+    std::vector<uint32_t> component_by_vertex;
+    size_t count = 0;
+};
+
+template <typename Weight>
+Components FindComponents(const DirectedWeightedGraph<Weight>& graph);
+
 template <typename Weight>
 DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
     : incidence_lists_(vertex_count) {
 }
 
+template <typename Weight>
+VertexId DirectedWeightedGraph<Weight>::AddVertex() {
+    Thaw();
+    incidence_lists_.emplace_back();
+    return incidence_lists_.size() - 1;
+}
+
 template <typename Weight>
 EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+    Thaw();
+    incidence_lists_.at(edge.from).push_back(edges_.size());
     edges_.push_back(edge);
-    const EdgeId id = edges_.size() - 1;
-    incidence_lists_.at(edge.from).push_back(id);
-    return id;
+    return edges_.size() - 1;
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::ReserveEdges(size_t edge_count) {
+    edges_.reserve(edge_count);
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::RemoveEdge(EdgeId edge_id) {
+    Thaw();
+    IncidenceList& incidence_list = incidence_lists_.at(edges_.at(edge_id).from);
+    incidence_list.erase(std::remove(incidence_list.begin(), incidence_list.end(), edge_id), incidence_list.end());
+}
+
+template <typename Weight>
+size_t DirectedWeightedGraph<Weight>::RemoveParallelEdges() {
+    Thaw();
+    constexpr EdgeId NO_EDGE = static_cast<EdgeId>(-1);
+    std::vector<EdgeId> best_edge_by_target(incidence_lists_.size(), NO_EDGE);
+    size_t removed_count = 0;
+    for (IncidenceList& incidence_list : incidence_lists_) {
+        for (const EdgeId edge_id : incidence_list) {
+            EdgeId& best_edge_id = best_edge_by_target[edges_[edge_id].to];
+            if (best_edge_id == NO_EDGE || edges_[edge_id].weight < edges_[best_edge_id].weight
+                || (!(edges_[best_edge_id].weight < edges_[edge_id].weight) && edge_id < best_edge_id)) {
+                best_edge_id = edge_id;
+            }
+        }
+        const auto removed_begin = std::remove_if(incidence_list.begin(), incidence_list.end(), 
+                                                  [this, &best_edge_by_target](EdgeId edge_id) {
+            return best_edge_by_target[edges_[edge_id].to] != edge_id;
+        });
+        removed_count += incidence_list.end() - removed_begin;
+        incidence_list.erase(removed_begin, incidence_list.end());
+        for (const EdgeId edge_id : incidence_list) {
+            best_edge_by_target[edges_[edge_id].to] = NO_EDGE;
+        }
+    }
+    return removed_count;
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::Freeze() {
+    if (is_frozen_) {
+        return;
+    }
+    const size_t vertex_count = incidence_lists_.size();
+    incidence_offsets_.assign(vertex_count + 1, 0);
+    incident_edges_.reserve(edges_.size());
+    incident_targets_.reserve(edges_.size());
+    incident_weights_.reserve(edges_.size());
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        for (const EdgeId edge_id : incidence_lists_[vertex]) {
+            incident_edges_.push_back(edge_id);
+            incident_targets_.push_back(edges_[edge_id].to);
+            incident_weights_.push_back(edges_[edge_id].weight);
+        }
+        incidence_offsets_[vertex + 1] = incident_edges_.size();
+    }
+    std::vector<IncidenceList>().swap(incidence_lists_);
+    is_frozen_ = true;
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::Thaw() {
+    if (!is_frozen_) {
+        return;
+    }
+    const size_t vertex_count = incidence_offsets_.size() - 1;
+    incidence_lists_.resize(vertex_count);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        incidence_lists_[vertex].assign(incident_edges_.begin() + incidence_offsets_[vertex],
+                                        incident_edges_.begin() + incidence_offsets_[vertex + 1]);
+    }
+    std::vector<size_t>().swap(incidence_offsets_);
+    std::vector<EdgeId>().swap(incident_edges_);
+    std::vector<VertexId>().swap(incident_targets_);
+    std::vector<Weight>().swap(incident_weights_);
+    is_frozen_ = false;
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+    return is_frozen_;
 }
 
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-    return incidence_lists_.size();
+    return is_frozen_ ? incidence_offsets_.size() - 1 : incidence_lists_.size();
 }
 
 template <typename Weight>
@@ -63,12 +194,70 @@ size_t DirectedWeightedGraph<Weight>::GetEdgeCount() const {
 
 template <typename Weight>
 const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
-    return edges_.at(edge_id);
+    // Замороженный граф читают движки при восстановлении путей по своим же номерам рёбер
+    return is_frozen_ ? edges_[edge_id] : edges_.at(edge_id);
 }
 
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
-    return ranges::AsRange(incidence_lists_.at(vertex));
+    if (!is_frozen_) {
+        const IncidenceList& incidence_list = incidence_lists_.at(vertex);
+        return {incidence_list.data(), incidence_list.data() + incidence_list.size()};
+    }
+    if (vertex >= GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    return {incident_edges_.data() + incidence_offsets_[vertex], incident_edges_.data() + incidence_offsets_[vertex + 1]};
+}
+
+template <typename Weight>
+template <typename Function>
+void DirectedWeightedGraph<Weight>::ForEachIncidentEdge(VertexId vertex, Function function) const {
+    if (is_frozen_) {
+        for (size_t index = incidence_offsets_[vertex]; index < incidence_offsets_[vertex + 1]; ++index) {
+            function(incident_edges_[index], incident_targets_[index], incident_weights_[index]);
+        }
+    } else {
+        for (const EdgeId edge_id : incidence_lists_[vertex]) {
+            const Edge<Weight>& edge = edges_[edge_id];
+            function(edge_id, edge.to, edge.weight);
+        }
+    }
+}
+
+template <typename Weight>
+Components FindComponents(const DirectedWeightedGraph<Weight>& graph) {
+    const size_t vertex_count = graph.GetVertexCount();
+    std::vector<VertexId> parents(vertex_count);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        parents[vertex] = vertex;
+    }
+    auto find_root = [&parents](VertexId vertex) {
+        while (parents[vertex] != vertex) {
+            parents[vertex] = parents[parents[vertex]];
+            vertex = parents[vertex];
+        }
+        return vertex;
+    };
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        graph.ForEachIncidentEdge(vertex, [&](EdgeId, VertexId to, Weight) {
+            const VertexId root_from = find_root(vertex);
+            const VertexId root_to = find_root(to);
+            // Корнем становится меньшая вершина, поэтому корень компоненты — её наименьшая вершина
+            if (root_from != root_to) {
+                parents[std::max(root_from, root_to)] = std::min(root_from, root_to);
+            }
+        });
+    }
+    Components components;
+    components.component_by_vertex.resize(vertex_count);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        const VertexId root = find_root(vertex);
+        components.component_by_vertex[vertex] = root == vertex 
+                                                 ? static_cast<uint32_t>(components.count++)
+                                                 : components.component_by_vertex[root];
+    }
+    return components;
 }
 }  // namespace graph
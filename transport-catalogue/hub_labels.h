@@ -0,0 +1,584 @@
+#pragma once
+
+#include "graph.h"
+#include "parallel.h"
+#include "router.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Метки хабов: у каждой вершины v два отсортированных по рангу хаба списка — веса путей
+// из v в хабы и из хабов в v. Любой кратчайший путь проходит через общий хаб своих концов,
+// поэтому вес пути — минимум по пересечению двух списков, без поиска по графу.
+// Метки строятся обрезанными поисками Дейкстры (pruned landmark labeling) от самых
+// важных хабов к наименее важным; хабы обрабатываются пачками, поиски пачки идут
+// параллельно и видят только метки прежних пачек, так что результат не зависит от числа потоков.
+// После изменения графа метки помечаются устаревшими и строятся заново при первом запросе,
+// так что серия изменений стоит одного построения
+template <typename Weight>
+class HubLabels final : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    struct Stats {
+        size_t label_entry_count = 0;
+        size_t memory_usage = 0;
+        std::chrono::milliseconds preprocessing_time{0};
+    };
+
+    explicit HubLabels(const Graph& graph, size_t threads_count = 1);
+
+    using RoutingEngine<Weight>::BuildRoute;
+    // Путь восстанавливается по рёбрам-родителям из меток, без поиска по графу
+    std::optional<Weight> BuildRoute(VertexId from, VertexId to, std::vector<EdgeId>& edges) const override;
+    WeightsMatrix<Weight> BuildWeightsMatrix(const std::vector<VertexId>& sources,
+                                             const std::vector<VertexId>& targets) const override;
+    // Только вес пути: пересечение меток без восстановления рёбер
+    std::optional<Weight> ComputeWeight(VertexId from, VertexId to) const;
+    bool UpdateEdges(const std::vector<EdgeId>& added_edges, const std::vector<EdgeId>& removed_edges) override;
+
+    // Статистика последнего построения меток
+    const Stats& GetStats() const;
+
+private:
+    using EdgeIndex = uint32_t;
+
+    static constexpr EdgeIndex NO_EDGE = std::numeric_limits<EdgeIndex>::max();
+    static constexpr uint32_t NO_HUB = std::numeric_limits<uint32_t>::max();
+    // Первые хабы самые важные и должны обрезать поиски друг друга, поэтому пачки
+    // растут с числом обработанных хабов
+    static constexpr size_t BATCH_SIZE_DIVISOR = 32;
+    static constexpr size_t MAX_BATCH_SIZE = 64;
+    static constexpr size_t ORDER_SAMPLE_COUNT = 64;
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight UNREACHABLE_WEIGHT = std::numeric_limits<Weight>::has_infinity
+                                                 ? std::numeric_limits<Weight>::infinity()
+                                                 : std::numeric_limits<Weight>::max() / 2;
+
+    struct LabelEntry {
+        uint32_t hub;
+        Weight weight;
+        EdgeIndex parent_edge;
+    };
+
+    // Метки всех вершин подряд; хаб — ранг вершины-хаба. У прямых меток parent_edge —
+    // первое ребро пути из вершины в хаб, у обратных — последнее ребро пути из хаба в вершину
+    struct Labels {
+        std::vector<size_t> offsets;
+        std::vector<uint32_t> hubs;
+        std::vector<Weight> weights;
+        std::vector<EdgeIndex> parent_edges;
+    };
+
+    struct Adjacency {
+        std::vector<size_t> offsets;
+        std::vector<EdgeIndex> edges;
+    };
+
+    struct SearchSpace {
+        std::vector<Weight> weights;
+        std::vector<EdgeIndex> parent_edges;
+        std::vector<VertexId> touched;
+        std::vector<Weight> hub_weights;
+        MinQueue<std::pair<Weight, VertexId>> queue;
+    };
+
+    // Дерево кратчайших путей из образца для выбора порядка хабов; sizes — число
+    // потомков, пути к которым ещё не покрыты выбранными хабами, с самой вершиной
+    struct SampleTree {
+        std::vector<uint32_t> parents;
+        std::vector<uint32_t> sizes;
+        std::vector<uint32_t> child_offsets;
+        std::vector<uint32_t> children;
+    };
+
+    struct HubMatch {
+        Weight weight;
+        uint32_t hub;
+    };
+
+    void BuildLabels() const;
+    // Устаревшие метки строятся заново; запросы вызывают её первой
+    void EnsureLabels() const;
+    void BuildAdjacency(const Graph& graph, Adjacency& out_edges, Adjacency& in_edges) const;
+    void OrderHubs(const Adjacency& out_edges, const Adjacency& in_edges, size_t threads_count) const;
+    void RunPrunedSearch(const Adjacency& adjacency, bool forward, uint32_t hub_rank,
+                         const std::vector<std::vector<LabelEntry>>& hub_labels,
+                         const std::vector<std::vector<LabelEntry>>& vertex_labels,
+                         SearchSpace& search_space, std::vector<std::pair<VertexId, LabelEntry>>& entries) const;
+    static void FlattenLabels(std::vector<std::vector<LabelEntry>>& labels_by_vertex, Labels& labels);
+    std::optional<HubMatch> FindBestHub(VertexId from, VertexId to) const;
+    size_t FindEntry(const Labels& labels, VertexId vertex, uint32_t hub) const;
+
+    const Graph& graph_;
+    const size_t threads_count_;
+    mutable std::mutex build_mutex_;
+    mutable std::atomic<bool> are_labels_stale_{false};
+    mutable std::vector<VertexId> vertex_by_rank_;
+    mutable Labels forward_labels_;
+    mutable Labels backward_labels_;
+    mutable Stats stats_;
+};
+
+template <typename Weight>
+HubLabels<Weight>::HubLabels(const Graph& graph, size_t threads_count)
+    : graph_(graph)
+    , threads_count_(std::max<size_t>(threads_count, 1))
+{
+    BuildLabels();
+}
+
+template <typename Weight>
+bool HubLabels<Weight>::UpdateEdges([[maybe_unused]] const std::vector<EdgeId>& added_edges,
+                                    [[maybe_unused]] const std::vector<EdgeId>& removed_edges) {
+    are_labels_stale_.store(true, std::memory_order_release);
+    return true;
+}
+
+template <typename Weight>
+void HubLabels<Weight>::EnsureLabels() const {
+    if (!are_labels_stale_.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::lock_guard guard(build_mutex_);
+    if (are_labels_stale_.load(std::memory_order_relaxed)) {
+        BuildLabels();
+        are_labels_stale_.store(false, std::memory_order_release);
+    }
+}
+
+template <typename Weight>
+void HubLabels<Weight>::BuildLabels() const {
+    const auto start_time = std::chrono::steady_clock::now();
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (graph_.GetEdgeCount() >= NO_EDGE || vertex_count >= NO_HUB) {
+        throw std::length_error("Too many edges or vertices for hub labels");
+    }
+    vertex_by_rank_.assign(vertex_count, 0);
+    forward_labels_ = {};
+    backward_labels_ = {};
+    Adjacency out_edges;
+    Adjacency in_edges;
+    BuildAdjacency(graph_, out_edges, in_edges);
+
+    OrderHubs(out_edges, in_edges, threads_count_);
+
+    // Прямые метки пополняются обратными поисками из хабов, обратные — прямыми
+    std::vector<std::vector<LabelEntry>> forward_labels(vertex_count);
+    std::vector<std::vector<LabelEntry>> backward_labels(vertex_count);
+    const size_t threads_count = threads_count_;
+    std::vector<SearchSpace> search_spaces(threads_count);
+    for (SearchSpace& search_space : search_spaces) {
+        search_space.weights.assign(vertex_count, UNREACHABLE_WEIGHT);
+        search_space.parent_edges.assign(vertex_count, NO_EDGE);
+        search_space.hub_weights.assign(vertex_count, UNREACHABLE_WEIGHT);
+    }
+    std::vector<std::vector<std::pair<VertexId, LabelEntry>>> forward_entries;
+    std::vector<std::vector<std::pair<VertexId, LabelEntry>>> backward_entries;
+    for (size_t batch_begin = 0; batch_begin < vertex_count;) {
+        const size_t batch_size = std::clamp<size_t>(batch_begin / BATCH_SIZE_DIVISOR, 1, MAX_BATCH_SIZE);
+        const size_t batch_end = std::min(batch_begin + batch_size, vertex_count);
+        forward_entries.resize(batch_end - batch_begin);
+        backward_entries.resize(batch_end - batch_begin);
+        const size_t batch_threads_count = std::min(threads_count, batch_end - batch_begin);
+        parallel::RunInThreads(batch_threads_count, [&](size_t thread_index) {
+            for (size_t rank = batch_begin + thread_index; rank < batch_end; rank += batch_threads_count) {
+                const uint32_t hub_rank = static_cast<uint32_t>(rank);
+                RunPrunedSearch(out_edges, true, hub_rank, forward_labels, backward_labels,
+                                search_spaces[thread_index], backward_entries[rank - batch_begin]);
+                RunPrunedSearch(in_edges, false, hub_rank, backward_labels, forward_labels,
+                                search_spaces[thread_index], forward_entries[rank - batch_begin]);
+            }
+        });
+        // Хабы добавляются по возрастанию ранга, и метки остаются отсортированными
+        for (size_t i = 0; i < batch_end - batch_begin; ++i) {
+            for (const auto& [vertex, entry] : forward_entries[i]) {
+                forward_labels[vertex].push_back(entry);
+            }
+            for (const auto& [vertex, entry] : backward_entries[i]) {
+                backward_labels[vertex].push_back(entry);
+            }
+        }
+        batch_begin = batch_end;
+    }
+    FlattenLabels(forward_labels, forward_labels_);
+    FlattenLabels(backward_labels, backward_labels_);
+
+    stats_.label_entry_count = forward_labels_.hubs.size() + backward_labels_.hubs.size();
+    stats_.memory_usage = stats_.label_entry_count * (sizeof(uint32_t) + sizeof(Weight) + sizeof(EdgeIndex))
+                          + 2 * (vertex_count + 1) * sizeof(size_t) + vertex_count * sizeof(VertexId);
+    stats_.preprocessing_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                std::chrono::steady_clock::now() - start_time);
+}
+
+template <typename Weight>
+std::optional<Weight> HubLabels<Weight>::BuildRoute(VertexId from, VertexId to, std::vector<EdgeId>& edges) const {
+    edges.clear();
+    EnsureLabels();
+    const auto best_hub = FindBestHub(from, to);
+    if (!best_hub) {
+        return std::nullopt;
+    }
+    const VertexId hub = vertex_by_rank_[best_hub->hub];
+    for (VertexId vertex = from; vertex != hub;) {
+        const EdgeId edge_id = forward_labels_.parent_edges[FindEntry(forward_labels_, vertex, best_hub->hub)];
+        edges.push_back(edge_id);
+        vertex = graph_.GetEdge(edge_id).to;
+    }
+    const size_t hub_position = edges.size();
+    for (VertexId vertex = to; vertex != hub;) {
+        const EdgeId edge_id = backward_labels_.parent_edges[FindEntry(backward_labels_, vertex, best_hub->hub)];
+        edges.push_back(edge_id);
+        vertex = graph_.GetEdge(edge_id).from;
+    }
+    std::reverse(edges.begin() + hub_position, edges.end());
+    return best_hub->weight;
+}
+
+template <typename Weight>
+WeightsMatrix<Weight> HubLabels<Weight>::BuildWeightsMatrix(const std::vector<VertexId>& sources,
+                                                           const std::vector<VertexId>& targets) const {
+    EnsureLabels();
+    const size_t vertex_count = vertex_by_rank_.size();
+    const auto is_out_of_range = [vertex_count](VertexId vertex) {
+        return vertex >= vertex_count;
+    };
+    if (std::any_of(sources.begin(), sources.end(), is_out_of_range)
+        || std::any_of(targets.begin(), targets.end(), is_out_of_range)) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    WeightsMatrix<Weight> matrix(sources.size(), std::vector<std::optional<Weight>>(targets.size()));
+    // Метка источника раскладывается по рангам хабов, и каждая цель — один проход по
+    // своей метке с независимыми чтениями вместо слияния двух списков
+    std::vector<Weight> hub_weights(vertex_count, UNREACHABLE_WEIGHT);
+    for (size_t source_index = 0; source_index < sources.size(); ++source_index) {
+        const VertexId source = sources[source_index];
+        const size_t source_begin = forward_labels_.offsets[source];
+        const size_t source_end = forward_labels_.offsets[source + 1];
+        for (size_t i = source_begin; i < source_end; ++i) {
+            hub_weights[forward_labels_.hubs[i]] = forward_labels_.weights[i];
+        }
+        for (size_t target_index = 0; target_index < targets.size(); ++target_index) {
+            const VertexId target = targets[target_index];
+            Weight best_weight = UNREACHABLE_WEIGHT;
+            for (size_t j = backward_labels_.offsets[target]; j < backward_labels_.offsets[target + 1]; ++j) {
+                best_weight = std::min(best_weight, hub_weights[backward_labels_.hubs[j]] + backward_labels_.weights[j]);
+            }
+            if (best_weight < UNREACHABLE_WEIGHT) {
+                matrix[source_index][target_index] = best_weight;
+            }
+        }
+        for (size_t i = source_begin; i < source_end; ++i) {
+            hub_weights[forward_labels_.hubs[i]] = UNREACHABLE_WEIGHT;
+        }
+    }
+    return matrix;
+}
+
+template <typename Weight>
+std::optional<Weight> HubLabels<Weight>::ComputeWeight(VertexId from, VertexId to) const {
+    EnsureLabels();
+    const auto best_hub = FindBestHub(from, to);
+    if (!best_hub) {
+        return std::nullopt;
+    }
+    return best_hub->weight;
+}
+
+template <typename Weight>
+const typename HubLabels<Weight>::Stats& HubLabels<Weight>::GetStats() const {
+    return stats_;
+}
+
+template <typename Weight>
+void HubLabels<Weight>::BuildAdjacency(const Graph& graph, Adjacency& out_edges, Adjacency& in_edges) const {
+    const size_t vertex_count = graph.GetVertexCount();
+    out_edges.offsets.assign(vertex_count + 1, 0);
+    in_edges.offsets.assign(vertex_count + 1, 0);
+    // Петли на кратчайшие пути не влияют
+    const auto for_each_edge = [&graph, vertex_count](auto function) {
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            graph.ForEachIncidentEdge(vertex, [&](EdgeId edge_id, VertexId to, Weight weight) {
+                if (weight < ZERO_WEIGHT) {
+                    throw std::domain_error("Edges' weights should be non-negative");
+                }
+                if (vertex != to) {
+                    function(vertex, to, static_cast<EdgeIndex>(edge_id));
+                }
+            });
+        }
+    };
+    for_each_edge([&](VertexId from, VertexId to, EdgeIndex) {
+        ++out_edges.offsets[from + 1];
+        ++in_edges.offsets[to + 1];
+    });
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        out_edges.offsets[vertex + 1] += out_edges.offsets[vertex];
+        in_edges.offsets[vertex + 1] += in_edges.offsets[vertex];
+    }
+    out_edges.edges.resize(out_edges.offsets.back());
+    in_edges.edges.resize(in_edges.offsets.back());
+    std::vector<size_t> out_positions(out_edges.offsets.begin(), out_edges.offsets.end() - 1);
+    std::vector<size_t> in_positions(in_edges.offsets.begin(), in_edges.offsets.end() - 1);
+    for_each_edge([&](VertexId from, VertexId to, EdgeIndex edge_id) {
+        out_edges.edges[out_positions[from]++] = edge_id;
+        in_edges.edges[in_positions[to]++] = edge_id;
+    });
+}
+
+// Жадный порядок по покрытию путей: строятся деревья кратчайших путей из равномерно
+// выбранных вершин в обе стороны, и хабом каждый раз становится вершина, через которую
+// проходит больше всего ещё не покрытых путей этих деревьев, то есть у которой больше
+// всего живых потомков. Остальные вершины, когда пути кончатся, идут по убыванию степени
+template <typename Weight>
+void HubLabels<Weight>::OrderHubs(const Adjacency& out_edges, const Adjacency& in_edges, size_t threads_count) const {
+    const size_t vertex_count = vertex_by_rank_.size();
+    const size_t tree_count = 2 * std::min(vertex_count, ORDER_SAMPLE_COUNT);
+    std::vector<SampleTree> trees(tree_count);
+    threads_count = std::clamp<size_t>(threads_count, 1, std::max<size_t>(tree_count, 1));
+    parallel::RunInThreads(threads_count, [&](size_t thread_index) {
+        std::vector<Weight> weights(vertex_count, UNREACHABLE_WEIGHT);
+        std::vector<VertexId> settled;
+        MinQueue<std::pair<Weight, VertexId>> queue;
+        for (size_t tree_index = thread_index; tree_index < tree_count; tree_index += threads_count) {
+            const bool forward = tree_index % 2 == 0;
+            const Adjacency& adjacency = forward ? out_edges : in_edges;
+            const VertexId source = tree_index / 2 * vertex_count / (tree_count / 2);
+            SampleTree& tree = trees[tree_index];
+            tree.parents.assign(vertex_count, NO_HUB);
+            tree.sizes.assign(vertex_count, 0);
+            weights[source] = ZERO_WEIGHT;
+            queue.push({ZERO_WEIGHT, source});
+            while (!queue.empty()) {
+                const auto [weight, vertex] = queue.top();
+                queue.pop();
+                if (weights[vertex] < weight) {
+                    continue;
+                }
+                settled.push_back(vertex);
+                for (size_t i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; ++i) {
+                    const auto& edge = graph_.GetEdge(adjacency.edges[i]);
+                    const VertexId next = forward ? edge.to : edge.from;
+                    if (weight + edge.weight < weights[next]) {
+                        weights[next] = weight + edge.weight;
+                        tree.parents[next] = static_cast<uint32_t>(vertex);
+                        queue.push({weights[next], next});
+                    }
+                }
+            }
+            tree.child_offsets.assign(vertex_count + 1, 0);
+            for (auto it = settled.rbegin(); it != settled.rend(); ++it) {
+                tree.sizes[*it] += 1;
+                if (tree.parents[*it] != NO_HUB) {
+                    tree.sizes[tree.parents[*it]] += tree.sizes[*it];
+                    ++tree.child_offsets[tree.parents[*it] + 1];
+                }
+            }
+            for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+                tree.child_offsets[vertex + 1] += tree.child_offsets[vertex];
+            }
+            tree.children.resize(tree.child_offsets.back());
+            std::vector<uint32_t> positions(tree.child_offsets.begin(), tree.child_offsets.end() - 1);
+            for (const VertexId vertex : settled) {
+                if (tree.parents[vertex] != NO_HUB) {
+                    tree.children[positions[tree.parents[vertex]]++] = static_cast<uint32_t>(vertex);
+                }
+                weights[vertex] = UNREACHABLE_WEIGHT;
+            }
+            settled.clear();
+        }
+    });
+
+    std::vector<uint64_t> scores(vertex_count, 0);
+    for (const SampleTree& tree : trees) {
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            scores[vertex] += tree.parents[vertex] != NO_HUB ? tree.sizes[vertex] : 0;
+        }
+    }
+    const std::vector<uint64_t> initial_scores = scores;
+    // При равенстве вперёд вершина с меньшим номером
+    std::priority_queue<std::pair<uint64_t, int64_t>> queue;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        queue.push({scores[vertex], -static_cast<int64_t>(vertex)});
+    }
+    std::vector<bool> is_ranked(vertex_count, false);
+    std::vector<uint32_t> stack;
+    size_t rank = 0;
+    while (!queue.empty() && queue.top().first > 0) {
+        const auto [score, negative_vertex] = queue.top();
+        queue.pop();
+        const VertexId vertex = static_cast<VertexId>(-negative_vertex);
+        if (score != scores[vertex]) {
+            queue.push({scores[vertex], negative_vertex});
+            continue;
+        }
+        vertex_by_rank_[rank++] = vertex;
+        is_ranked[vertex] = true;
+        // Пути через вершину покрыты: её поддерево уходит из дерева и из счёта предков
+        for (SampleTree& tree : trees) {
+            const uint32_t size = tree.sizes[vertex];
+            if (size == 0) {
+                continue;
+            }
+            for (uint32_t ancestor = tree.parents[vertex]; ancestor != NO_HUB; ancestor = tree.parents[ancestor]) {
+                tree.sizes[ancestor] -= size;
+                scores[ancestor] -= tree.parents[ancestor] != NO_HUB ? size : 0;
+            }
+            stack.assign(1, static_cast<uint32_t>(vertex));
+            while (!stack.empty()) {
+                const uint32_t descendant = stack.back();
+                stack.pop_back();
+                scores[descendant] -= tree.parents[descendant] != NO_HUB ? tree.sizes[descendant] : 0;
+                tree.sizes[descendant] = 0;
+                for (uint32_t i = tree.child_offsets[descendant]; i < tree.child_offsets[descendant + 1]; ++i) {
+                    if (tree.sizes[tree.children[i]] > 0) {
+                        stack.push_back(tree.children[i]);
+                    }
+                }
+            }
+        }
+    }
+    trees.clear();
+    const size_t ranked_count = rank;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        if (!is_ranked[vertex]) {
+            vertex_by_rank_[rank++] = vertex;
+        }
+    }
+    std::stable_sort(vertex_by_rank_.begin() + ranked_count, vertex_by_rank_.end(), [&](VertexId lhs, VertexId rhs) {
+        return initial_scores[lhs] > initial_scores[rhs];
+    });
+}
+
+template <typename Weight>
+void HubLabels<Weight>::RunPrunedSearch(const Adjacency& adjacency, bool forward, uint32_t hub_rank,
+                                        const std::vector<std::vector<LabelEntry>>& hub_labels,
+                                        const std::vector<std::vector<LabelEntry>>& vertex_labels,
+                                        SearchSpace& search_space,
+                                        std::vector<std::pair<VertexId, LabelEntry>>& entries) const {
+    const VertexId hub = vertex_by_rank_[hub_rank];
+    entries.clear();
+    // Веса между хабом и уже обработанными хабами — по одному разу на поиск,
+    // тогда проверка вершины стоит одного прохода по её метке
+    for (const LabelEntry& entry : hub_labels[hub]) {
+        search_space.hub_weights[entry.hub] = entry.weight;
+    }
+    search_space.weights[hub] = ZERO_WEIGHT;
+    search_space.touched.push_back(hub);
+    search_space.queue.push({ZERO_WEIGHT, hub});
+    while (!search_space.queue.empty()) {
+        const auto [weight, vertex] = search_space.queue.top();
+        search_space.queue.pop();
+        if (search_space.weights[vertex] < weight) {
+            continue;
+        }
+        // Вершину уже покрывает более важный хаб — ни её, ни путей через неё в метки не надо
+        const bool is_covered = std::any_of(vertex_labels[vertex].begin(), vertex_labels[vertex].end(),
+                                            [&, weight = weight](const LabelEntry& entry) {
+            const Weight hub_weight = search_space.hub_weights[entry.hub];
+            return hub_weight != UNREACHABLE_WEIGHT && !(weight < hub_weight + entry.weight);
+        });
+        if (is_covered) {
+            continue;
+        }
+        entries.push_back({vertex, {hub_rank, weight, search_space.parent_edges[vertex]}});
+        for (size_t i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; ++i) {
+            const EdgeIndex edge_id = adjacency.edges[i];
+            const auto& edge = graph_.GetEdge(edge_id);
+            const VertexId next = forward ? edge.to : edge.from;
+            const Weight candidate_weight = weight + edge.weight;
+            Weight& next_weight = search_space.weights[next];
+            if (candidate_weight < next_weight) {
+                if (next_weight == UNREACHABLE_WEIGHT) {
+                    search_space.touched.push_back(next);
+                }
+                next_weight = candidate_weight;
+                search_space.parent_edges[next] = edge_id;
+                search_space.queue.push({candidate_weight, next});
+            }
+        }
+    }
+    for (const VertexId vertex : search_space.touched) {
+        search_space.weights[vertex] = UNREACHABLE_WEIGHT;
+        search_space.parent_edges[vertex] = NO_EDGE;
+    }
+    search_space.touched.clear();
+    for (const LabelEntry& entry : hub_labels[hub]) {
+        search_space.hub_weights[entry.hub] = UNREACHABLE_WEIGHT;
+    }
+}
+
+template <typename Weight>
+void HubLabels<Weight>::FlattenLabels(std::vector<std::vector<LabelEntry>>& labels_by_vertex, Labels& labels) {
+    labels.offsets.reserve(labels_by_vertex.size() + 1);
+    labels.offsets.push_back(0);
+    for (const auto& vertex_labels : labels_by_vertex) {
+        labels.offsets.push_back(labels.offsets.back() + vertex_labels.size());
+    }
+    labels.hubs.reserve(labels.offsets.back());
+    labels.weights.reserve(labels.offsets.back());
+    labels.parent_edges.reserve(labels.offsets.back());
+    for (auto& vertex_labels : labels_by_vertex) {
+        for (const LabelEntry& entry : vertex_labels) {
+            labels.hubs.push_back(entry.hub);
+            labels.weights.push_back(entry.weight);
+            labels.parent_edges.push_back(entry.parent_edge);
+        }
+        vertex_labels = {};
+    }
+}
+
+template <typename Weight>
+std::optional<typename HubLabels<Weight>::HubMatch> HubLabels<Weight>::FindBestHub(VertexId from, VertexId to) const {
+    if (from >= vertex_by_rank_.size() || to >= vertex_by_rank_.size()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    const uint32_t* forward_hubs = forward_labels_.hubs.data();
+    const uint32_t* backward_hubs = backward_labels_.hubs.data();
+    const Weight* forward_weights = forward_labels_.weights.data();
+    const Weight* backward_weights = backward_labels_.weights.data();
+    size_t i = forward_labels_.offsets[from];
+    const size_t i_end = forward_labels_.offsets[from + 1];
+    size_t j = backward_labels_.offsets[to];
+    const size_t j_end = backward_labels_.offsets[to + 1];
+    HubMatch best_hub{UNREACHABLE_WEIGHT, NO_HUB};
+    // Без ветвлений на сравнении хабов: сумма считается на каждом шаге и отбрасывается,
+    // если хабы разные
+    while (i < i_end && j < j_end) {
+        const uint32_t forward_hub = forward_hubs[i];
+        const uint32_t backward_hub = backward_hubs[j];
+        const Weight sum = forward_weights[i] + backward_weights[j];
+        const Weight weight = forward_hub == backward_hub ? sum : UNREACHABLE_WEIGHT;
+        if (weight < best_hub.weight) {
+            best_hub = {weight, forward_hub};
+        }
+        i += forward_hub <= backward_hub;
+        j += backward_hub <= forward_hub;
+    }
+    if (best_hub.hub == NO_HUB) {
+        return std::nullopt;
+    }
+    return best_hub;
+}
+
+template <typename Weight>
+size_t HubLabels<Weight>::FindEntry(const Labels& labels, VertexId vertex, uint32_t hub) const {
+    // Вершина пути к хабу не обрезана поиском из него, так что хаб в её метке есть
+    const auto begin = labels.hubs.begin() + labels.offsets[vertex];
+    const auto end = labels.hubs.begin() + labels.offsets[vertex + 1];
+    return std::lower_bound(begin, end, hub) - labels.hubs.begin();
+}
+
+}  // namespace graph
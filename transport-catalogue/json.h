@@ -142,6 +142,10 @@ public:
         return root_;
     }
 
+    Node& GetRoot() {
+        return root_;
+    }
+
 private:
     Node root_;
 };
@@ -1,19 +1,29 @@
 #include "json_builder.h"
 #include "json_reader.h"
+#include "parallel.h"
 
-#include <set>
 #include <sstream>
 
 using namespace std::literals;
 
 void JsonReader::FillCatalogue(transport::TransportCatalogue& catalogue) const {
+    if (!requests_doc_.GetRoot().AsDict().count("base_requests"s)) {
+        return;
+    }
     const auto& base_requests_array = requests_doc_.GetRoot().AsDict().at("base_requests"s).AsArray();
     FillCatalogueWithStops(base_requests_array, catalogue);
     FillCatalogueWithDistances(base_requests_array, catalogue);
     FillCatalogueWithRoutes(base_requests_array, catalogue);
 }
 
+void JsonReader::ReleaseBaseRequests() {
+    requests_doc_.GetRoot().AsDict().erase("base_requests"s);
+}
+
 void JsonReader::FillRenderer(MapRenderer& renderer) const {
+    if (!requests_doc_.GetRoot().AsDict().count("render_settings"s)) {
+        return;
+    }
     const auto& render_settings_map = requests_doc_.GetRoot().AsDict().at("render_settings"s).AsDict();
     renderer.SetSettings({render_settings_map.at("width"s).AsDouble(),
                           render_settings_map.at("height"s).AsDouble(),
@@ -33,12 +43,42 @@ void JsonReader::FillRenderer(MapRenderer& renderer) const {
 
 void JsonReader::FillTransportRouter(transport::TransportRouter& transport_router) const {
     const auto& routing_settings_map = requests_doc_.GetRoot().AsDict().at("routing_settings"s).AsDict();
-    transport_router.SetSettings({routing_settings_map.at("bus_velocity"s).AsDouble(),
-                                  routing_settings_map.at("bus_wait_time"s).AsInt()});
+    transport::RoutingSettings routing_settings;
+    routing_settings.bus_velocity = routing_settings_map.at("bus_velocity"s).AsDouble();
+    routing_settings.bus_wait_time = routing_settings_map.at("bus_wait_time"s).AsInt();
+    if (routing_settings_map.count("router_type"s)) {
+        routing_settings.router_type = ReadRouterTypeFromJson(routing_settings_map.at("router_type"s));
+    }
+    if (routing_settings_map.count("graph_model"s)) {
+        routing_settings.graph_model = ReadGraphModelFromJson(routing_settings_map.at("graph_model"s));
+    }
+    if (routing_settings_map.count("cached_trees_limit"s)) {
+        const int cached_trees_limit = routing_settings_map.at("cached_trees_limit"s).AsInt();
+        if (cached_trees_limit < 0) {
+            throw std::invalid_argument("Negative cached trees limit: "s + std::to_string(cached_trees_limit));
+        }
+        routing_settings.cached_trees_limit = cached_trees_limit;
+    }
+    if (routing_settings_map.count("threads_count"s)) {
+        // Ноль или отрицательное число потоков — все аппаратные потоки, как без ключа
+        const int threads_count = routing_settings_map.at("threads_count"s).AsInt();
+        routing_settings.threads_count = threads_count > 0 ? static_cast<size_t>(threads_count) 
+                                                           : parallel::GetHardwareThreadsCount();
+    }
+    if (routing_settings_map.count("compact_parallel_edges"s)) {
+        routing_settings.compact_parallel_edges = routing_settings_map.at("compact_parallel_edges"s).AsBool();
+    }
+    transport_router.SetSettings(routing_settings);
+}
+
+std::filesystem::path JsonReader::GetSerializationFile() const {
+    return requests_doc_.GetRoot().AsDict().at("serialization_settings"s).AsDict().at("file"s).AsString();
 }
 
 void JsonReader::PrintRequestsResults(const RequestHandler& handler, std::ostream& out) const {
     json::Array result;
+    // Общий для всех запросов Route буфер пути
+    transport::PathInfo path_info;
     const auto& stat_requests_array = requests_doc_.GetRoot().AsDict().at("stat_requests"s).AsArray();
     for (const auto& stat_request : stat_requests_array) {
         const auto& stat_request_map = stat_request.AsDict();
@@ -53,11 +93,20 @@ void JsonReader::PrintRequestsResults(const RequestHandler& handler, std::ostrea
         if (stat_request_map.at("type"s).AsString() == "Map"s) {
             result.push_back(GetMapRequestResult(stat_request_map.at("id"s).AsInt(), handler));
         }
-        if (stat_request_map.at("type"s).AsString() == "Route"s) {
+        if (stat_request_map.at("type"s).AsString() == "Route"s && stat_request_map.count("pareto"s)
+            && stat_request_map.at("pareto"s).AsBool()) {
+            result.push_back(GetParetoPathsRequestResult(stat_request_map, handler));
+        } else if (stat_request_map.at("type"s).AsString() == "Route"s) {
             result.push_back(GetPathRequestResult(stat_request_map.at("from"s).AsString(),
                                                   stat_request_map.at("to"s).AsString(),
-                                                  stat_request_map.at("id"s).AsInt(), handler));
+                                                  stat_request_map.at("id"s).AsInt(), handler, path_info));
         }        
+        if (stat_request_map.at("type"s).AsString() == "Reachable"s) {
+            result.push_back(GetReachableRequestResult(stat_request_map, handler));
+        }
+        if (stat_request_map.at("type"s).AsString() == "RouteMatrix"s) {
+            result.push_back(GetRouteMatrixRequestResult(stat_request_map, handler));
+        }
     }
     json::Print(json::Document{result}, out);
 }
@@ -80,14 +129,16 @@ void JsonReader::FillCatalogueWithStops(const json::Array& base_requests,
 
 void JsonReader::FillCatalogueWithDistances(const json::Array& base_requests, 
                                                   transport::TransportCatalogue& catalogue) const {
+    std::vector<transport::TransportCatalogue::RoadDistance> distances;
     for (const auto& base_request : base_requests) {
         const auto& base_request_map = base_request.AsDict();
         if (base_request_map.at("type"s).AsString() == "Stop"s) {
             for (const auto& [stop_to, distance] : base_request_map.at("road_distances"s).AsDict()) {
-                catalogue.AddDistance(base_request_map.at("name"s).AsString(), stop_to, distance.AsInt());    
+                distances.push_back({base_request_map.at("name"s).AsString(), stop_to, distance.AsInt()});    
             }
         }
     }    
+    catalogue.AddDistances(distances);
 }
 
 void JsonReader::FillCatalogueWithRoutes(const json::Array& base_requests, 
@@ -133,16 +184,51 @@ std::vector<svg::Color> JsonReader::ReadArrayColorFromJson(std::vector<json::Nod
     return colors;
 }
 
+transport::RouterType JsonReader::ReadRouterTypeFromJson(const json::Node& router_type_node) const {
+    const std::string& router_type = router_type_node.AsString();
+    if (router_type == "all_pairs"s) {
+        return transport::RouterType::ALL_PAIRS;
+    }
+    if (router_type == "on_demand"s) {
+        return transport::RouterType::ON_DEMAND;
+    }
+    if (router_type == "contraction_hierarchy"s) {
+        return transport::RouterType::CONTRACTION_HIERARCHY;
+    }
+    if (router_type == "a_star"s) {
+        return transport::RouterType::A_STAR;
+    }
+    if (router_type == "raptor"s) {
+        return transport::RouterType::RAPTOR;
+    }
+    if (router_type == "hub_labels"s) {
+        return transport::RouterType::HUB_LABELS;
+    }
+    throw std::invalid_argument("Unknown router type: "s + router_type);
+}
+
+transport::GraphModel JsonReader::ReadGraphModelFromJson(const json::Node& graph_model_node) const {
+    const std::string& graph_model = graph_model_node.AsString();
+    if (graph_model == "stop_pairs"s) {
+        return transport::GraphModel::STOP_PAIRS;
+    }
+    if (graph_model == "route_stops"s) {
+        return transport::GraphModel::ROUTE_STOPS;
+    }
+    throw std::invalid_argument("Unknown graph model: "s + graph_model);
+}
+
 json::Node JsonReader::GetRouteRequestResult(std::string_view bus_name, int request_id, 
                                              const RequestHandler& handler) const {
-    if (!handler.GetBusStat(bus_name)) {
+    const auto bus_stat = handler.GetBusStat(bus_name);
+    if (!bus_stat) {
         return json::Builder{}.StartDict()
                                   .Key("request_id"s).Value(request_id)
                                   .Key("error_message"s).Value("not found"s)
                               .EndDict()
                               .Build();
     }
-    const auto route_info = *handler.GetBusStat(bus_name);
+    const auto& route_info = *bus_stat;
     return json::Builder{}.StartDict()
                               .Key("request_id"s).Value(request_id)
                               .Key("stop_count"s).Value(route_info.number_of_stops)
@@ -155,18 +241,17 @@ json::Node JsonReader::GetRouteRequestResult(std::string_view bus_name, int requ
 
 json::Node JsonReader::GetStopRequestResult(std::string_view stop_name, int request_id, 
                                             const RequestHandler& handler) const {
-    const auto routes_un_set_ptr = handler.GetBusesByStop(stop_name);
-    if (!routes_un_set_ptr) {
+    const auto buses = handler.GetBusesByStop(stop_name);
+    if (!buses) {
         return json::Builder{}.StartDict()
                                   .Key("request_id"s).Value(request_id)
                                   .Key("error_message"s).Value("not found"s)
                               .EndDict()
                               .Build();
     }
-    std::set<std::string> routes_set(routes_un_set_ptr->begin(), routes_un_set_ptr->end());
     json::Array routes_vec;
-    for (const auto& route : routes_set) {
-        routes_vec.push_back(route);
+    for (const std::string_view route : *buses) {
+        routes_vec.push_back(std::string(route));
     }
     return json::Builder{}.StartDict()
                               .Key("request_id"s).Value(request_id)
@@ -185,16 +270,111 @@ json::Node JsonReader::GetMapRequestResult(int request_id, const RequestHandler&
                           .Build();
 }
 
-json::Node JsonReader::GetPathRequestResult(std::string_view stop_from, std::string_view stop_to, 
-                                            int request_id, const RequestHandler& handler) const {
-    if (!handler.GetPathBetweenTwoStops(stop_from, stop_to)) {
+json::Node JsonReader::GetPathRequestResult(std::string_view stop_from, std::string_view stop_to, int request_id, 
+                                            const RequestHandler& handler, transport::PathInfo& path_info) const {
+    if (!handler.GetPathBetweenTwoStops(stop_from, stop_to, path_info)) {
+        return json::Builder{}.StartDict()
+                                  .Key("request_id"s).Value(request_id)
+                                  .Key("error_message"s).Value("not found"s)
+                              .EndDict()
+                              .Build();
+    }
+    return json::Builder{}.StartDict()
+                              .Key("request_id"s).Value(request_id)
+                              .Key("total_time"s).Value(path_info.total_time)
+                              .Key("items"s).Value(GetPathItems(path_info))
+                          .EndDict()
+                          .Build();    
+}
+
+json::Node JsonReader::GetParetoPathsRequestResult(const json::Dict& stat_request_map, 
+                                                   const RequestHandler& handler) const {
+    const int request_id = stat_request_map.at("id"s).AsInt();
+    const auto paths = handler.GetParetoPathsBetweenTwoStops(stat_request_map.at("from"s).AsString(), 
+                                                              stat_request_map.at("to"s).AsString());
+    if (paths.empty()) {
         return json::Builder{}.StartDict()
                                   .Key("request_id"s).Value(request_id)
                                   .Key("error_message"s).Value("not found"s)
                               .EndDict()
                               .Build();
     }
-    const auto path_info = *handler.GetPathBetweenTwoStops(stop_from, stop_to);
+    // Самый быстрый путь — последний, с наибольшим числом посадок
+    json::Array alternatives;
+    for (const auto& path_info : paths) {
+        alternatives.emplace_back(json::Builder{}.StartDict()
+                                                     .Key("total_time"s).Value(path_info.total_time)
+                                                     .Key("items"s).Value(GetPathItems(path_info))
+                                                 .EndDict()
+                                                 .Build());
+    }
+    return json::Builder{}.StartDict()
+                              .Key("request_id"s).Value(request_id)
+                              .Key("total_time"s).Value(paths.back().total_time)
+                              .Key("items"s).Value(GetPathItems(paths.back()))
+                              .Key("alternatives"s).Value(alternatives)
+                          .EndDict()
+                          .Build();
+}
+
+json::Node JsonReader::GetReachableRequestResult(const json::Dict& stat_request_map, 
+                                                 const RequestHandler& handler) const {
+    json::Array stops;
+    for (const auto& reachable_stop : handler.GetReachableStops(stat_request_map.at("from"s).AsString(), 
+                                                                stat_request_map.at("max_time"s).AsDouble())) {
+        stops.emplace_back(json::Builder{}.StartDict()
+                                              .Key("stop_name"s).Value(std::string(reachable_stop.stop_name))
+                                              .Key("time"s).Value(reachable_stop.time)
+                                          .EndDict()
+                                          .Build());
+    }
+    return json::Builder{}.StartDict()
+                              .Key("request_id"s).Value(stat_request_map.at("id"s).AsInt())
+                              .Key("stops"s).Value(stops)
+                          .EndDict()
+                          .Build();
+}
+
+json::Node JsonReader::GetRouteMatrixRequestResult(const json::Dict& stat_request_map, 
+                                                   const RequestHandler& handler) const {
+    auto read_stops = [](const json::Node& stops_node) {
+        std::vector<std::string_view> stops;
+        for (const auto& stop : stops_node.AsArray()) {
+            stops.push_back(stop.AsString());
+        }
+        return stops;
+    };
+    const bool with_itineraries = stat_request_map.count("with_itineraries"s) 
+                                  && stat_request_map.at("with_itineraries"s).AsBool();
+    const auto route_matrix = handler.GetRouteMatrix(read_stops(stat_request_map.at("from"s)), 
+                                                     read_stops(stat_request_map.at("to"s)), with_itineraries);
+    json::Array total_times;
+    for (const auto& total_times_row : route_matrix.total_times) {
+        json::Array row;
+        for (const auto& total_time : total_times_row) {
+            row.emplace_back(total_time ? json::Node(*total_time) : json::Node(nullptr));
+        }
+        total_times.emplace_back(std::move(row));
+    }
+    json::Builder builder;
+    builder.StartDict()
+               .Key("request_id"s).Value(stat_request_map.at("id"s).AsInt())
+               .Key("total_times"s).Value(total_times);
+    if (with_itineraries) {
+        json::Array itineraries;
+        for (const auto& itineraries_row : route_matrix.itineraries) {
+            json::Array row;
+            for (const auto& path_info : itineraries_row) {
+                row.emplace_back(path_info ? json::Node(GetPathItems(*path_info)) : json::Node(nullptr));
+            }
+            itineraries.emplace_back(std::move(row));
+        }
+        builder.Key("items"s).Value(itineraries);
+    }
+    return builder.EndDict().Build();
+}
+
+json::Array JsonReader::GetPathItems(const transport::PathInfo& path_info) const {
     json::Array items;
     for (auto& item : path_info.items) {
         items.emplace_back(json::Builder{}.StartDict()
@@ -211,10 +391,5 @@ json::Node JsonReader::GetPathRequestResult(std::string_view stop_from, std::str
                                           .EndDict()
                                           .Build());        
     }
-    return json::Builder{}.StartDict()
-                              .Key("request_id"s).Value(request_id)
-                              .Key("total_time"s).Value(path_info.total_time)
-                              .Key("items"s).Value(items)
-                          .EndDict()
-                          .Build();    
+    return items;
 }
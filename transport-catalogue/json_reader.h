@@ -6,6 +6,8 @@
 #include "transport_catalogue.h"
 #include "transport_router.h"
 
+#include <filesystem>
+
 class JsonReader {
 public:
     JsonReader(std::istream& input)
@@ -13,11 +15,16 @@ public:
     }
     
     void FillCatalogue(transport::TransportCatalogue& catalogue) const;
+    // Имена из base_requests после заполнения каталога живут в нём, а копии в документе
+    // больше не нужны
+    void ReleaseBaseRequests();
 
     void FillRenderer(MapRenderer& renderer) const;
     
     void FillTransportRouter(transport::TransportRouter& transport_router) const;
     
+    std::filesystem::path GetSerializationFile() const;
+    
     void PrintRequestsResults(const RequestHandler& handler, std::ostream& out) const;
     
     const json::Document& GetDocument() const;
@@ -32,6 +39,8 @@ private:
         
     svg::Color ReadColorFromJson(json::Node color) const;
     std::vector<svg::Color> ReadArrayColorFromJson(std::vector<json::Node> colors) const;
+    transport::RouterType ReadRouterTypeFromJson(const json::Node& router_type_node) const;
+    transport::GraphModel ReadGraphModelFromJson(const json::Node& graph_model_node) const;
     
     json::Node GetRouteRequestResult(std::string_view bus_name, int request_id, 
                                      const RequestHandler& handler) const;
@@ -39,8 +48,12 @@ private:
                                     const RequestHandler& handler) const;
     json::Node GetMapRequestResult(int request_id, const RequestHandler& handler) const;
     
-    json::Node GetPathRequestResult(std::string_view stop_from, std::string_view stop_to, 
-                                    int request_id, const RequestHandler& handler) const;
+    json::Node GetPathRequestResult(std::string_view stop_from, std::string_view stop_to, int request_id, 
+                                    const RequestHandler& handler, transport::PathInfo& path_info) const;
+    json::Node GetParetoPathsRequestResult(const json::Dict& stat_request_map, const RequestHandler& handler) const;
+    json::Node GetReachableRequestResult(const json::Dict& stat_request_map, const RequestHandler& handler) const;
+    json::Node GetRouteMatrixRequestResult(const json::Dict& stat_request_map, const RequestHandler& handler) const;
+    json::Array GetPathItems(const transport::PathInfo& path_info) const;
     
     json::Document requests_doc_;
 };
@@ -4,9 +4,31 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <sstream>
 
-int main () {
+using namespace std::literals;
+
+void PrintUsage(std::ostream& stream = std::cerr) {
+    stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv;
+}
+
+// Сводка построенного маршрутизатора после make_base; stdout остаётся пустым
+void PrintMakeBaseSummary(const transport::TransportRouter& router, std::ostream& stream = std::cerr) {
+    stream << "Removed parallel edges: "sv << router.GetRemovedParallelEdgeCount() << '\n';
+}
+
+int main (int argc, char* argv[]) {
+    if (argc > 2) {
+        PrintUsage();
+        return 1;
+    }
+    const std::string_view mode = argc == 2 ? argv[1] : ""sv;
+    if (!mode.empty() && mode != "make_base"sv && mode != "process_requests"sv) {
+        PrintUsage();
+        return 1;
+    }
+    
     transport::TransportCatalogue ctlg;
     MapRenderer renderer;
     transport::TransportRouter router;
@@ -14,12 +36,26 @@ int main () {
     JsonReader reader(std::cin);
     
     reader.FillCatalogue(ctlg);
+    reader.ReleaseBaseRequests();
     reader.FillRenderer(renderer);
-    reader.FillTransportRouter(router);
     
     RequestHandler handler(ctlg, renderer, router);
     
-    handler.UpdateTransportRouterData();
+    if (mode == "process_requests"sv) {
+        router.LoadSnapshot(ctlg, reader.GetSerializationFile());
+    } else {
+        reader.FillTransportRouter(router);
+        handler.UpdateTransportRouterData();
+        if (router.GetSettings().router_type == transport::RouterType::A_STAR && !router.IsHeuristicAdmissible()) {
+            std::cerr << "Warning: some road distances are shorter than straight lines, "sv
+                      << "A* heuristic is scaled down to stay admissible\n"sv;
+        }
+    }
     
-    reader.PrintRequestsResults(handler, std::cout);
+    if (mode == "make_base"sv) {
+        router.SaveSnapshot(ctlg, reader.GetSerializationFile());
+        PrintMakeBaseSummary(router);
+    } else {
+        reader.PrintRequestsResults(handler, std::cout);
+    }
 }
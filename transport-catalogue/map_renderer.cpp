@@ -13,7 +13,7 @@ void MapRenderer::SetSettings(RenderSettings settings) {
     settings_ = std::move(settings);
 }
     
-void MapRenderer::AddAllRoutesLines(const std::map<std::string_view, InfoForRenderRoute>& route_render_info_by_route_name, 
+void MapRenderer::AddAllRoutesLines(const std::vector<std::pair<std::string_view, InfoForRenderRoute>>& route_render_info_by_route_name, 
                                           svg::Document& document) const {
     size_t color_index = 0;
     size_t number_of_colors = settings_.color_palette.size();
@@ -38,7 +38,7 @@ void MapRenderer::AddAllRoutesLines(const std::map<std::string_view, InfoForRend
     }
 }
 
-void MapRenderer::AddAllRoutesTexts(const std::map<std::string_view, InfoForRenderRoute>& route_render_info_by_route_name,
+void MapRenderer::AddAllRoutesTexts(const std::vector<std::pair<std::string_view, InfoForRenderRoute>>& route_render_info_by_route_name,
                                           svg::Document& document) const {
     size_t color_index = 0;
     size_t number_of_colors = settings_.color_palette.size();
@@ -83,16 +83,16 @@ void MapRenderer::AddAllRoutesTexts(const std::map<std::string_view, InfoForRend
     }
 }
 
-void MapRenderer::AddAllStopsPoints(const std::map<std::string_view, svg::Point>& coords_of_stop_in_route_by_stop_name,
+void MapRenderer::AddAllStopsPoints(const std::vector<std::pair<std::string_view, svg::Point>>& coords_of_stop_in_route_by_stop_name,
                                           svg::Document& document) const {
-    for (const auto [stop_name, stop_coords] : coords_of_stop_in_route_by_stop_name) {
+    for (const auto& [stop_name, stop_coords] : coords_of_stop_in_route_by_stop_name) {
         document.Add(svg::Circle().SetCenter(stop_coords).SetRadius(settings_.stop_radius).SetFillColor("white"));
     }
 }
 
-void MapRenderer::AddAllStopsTexts(const std::map<std::string_view, svg::Point>& coords_of_stop_in_route_by_stop_name,
+void MapRenderer::AddAllStopsTexts(const std::vector<std::pair<std::string_view, svg::Point>>& coords_of_stop_in_route_by_stop_name,
                                          svg::Document& document) const {
-    for (const auto [stop_name, stop_coords] : coords_of_stop_in_route_by_stop_name) {
+    for (const auto& [stop_name, stop_coords] : coords_of_stop_in_route_by_stop_name) {
         svg::Text stop_name_text;
         svg::Text text_background;
         text_background.SetPosition(stop_coords)
@@ -118,46 +118,47 @@ void MapRenderer::AddAllStopsTexts(const std::map<std::string_view, svg::Point>&
     }
 }
 
-svg::Document MapRenderer::MakeSvgDocument(const std::unordered_map<std::string_view, const transport::Stop*>& all_stops,
-                                           const std::unordered_map<std::string_view, const transport::Route*>& all_routes) const {
+svg::Document MapRenderer::MakeSvgDocument(const transport::CatalogueSnapshot& snapshot) const {
+    // Через остановку проходит хоть один маршрут, если у неё непустой список автобусов
+    const auto& sorted_stops = snapshot.GetSortedStops();
+    std::vector<const transport::Stop*> stop_by_id(sorted_stops.size(), nullptr);
     std::vector<geo::Coordinates> coords_of_all_stops_in_routs;
-    for (const auto [stop_name, stop_info] : all_stops) {
-        for (const auto [route_name, route_info] : all_routes) {
-            if (std::count(route_info->stops.begin(), route_info->stops.end(), stop_name)) {
-                coords_of_all_stops_in_routs.push_back(stop_info->coordinates);
-                break;
-            }
-        }    
+    for (const transport::Stop* stop_info : sorted_stops) {
+        stop_by_id.at(stop_info->id) = stop_info;
+        const auto buses = snapshot.GetBusesByStop(stop_info->id);
+        if (buses.begin() != buses.end()) {
+            coords_of_all_stops_in_routs.push_back(stop_info->coordinates);
+        }
     }
     const SphereProjector proj_{coords_of_all_stops_in_routs.begin(), 
                                 coords_of_all_stops_in_routs.end(), settings_.width, settings_.height, settings_.padding};
     
     
-    std::map<std::string_view, InfoForRenderRoute> route_render_info_by_route_name;
-    for (const auto [route_name, route_info] : all_routes) {
+    std::vector<std::pair<std::string_view, InfoForRenderRoute>> route_render_info_by_route_name;
+    route_render_info_by_route_name.reserve(snapshot.GetSortedRoutes().size());
+    for (const transport::Route* route_info : snapshot.GetSortedRoutes()) {
         std::vector<svg::Point> all_stops_coords_in_route;
         if (!route_info->is_roundtrip) {
             all_stops_coords_in_route.reserve(route_info->stops.size() * 2 - 1);
         } else {
             all_stops_coords_in_route.reserve(route_info->stops.size());
         }    
-        for (const auto& stop_name : route_info->stops) {
-            all_stops_coords_in_route.push_back(proj_(all_stops.at(stop_name)->coordinates));    
+        for (const transport::StopId stop_id : route_info->stops) {
+            all_stops_coords_in_route.push_back(proj_(stop_by_id[stop_id]->coordinates));    
         }
         if (!route_info->is_roundtrip) {
             all_stops_coords_in_route.insert(all_stops_coords_in_route.end(), 
                                              std::next(all_stops_coords_in_route.rbegin()), all_stops_coords_in_route.rend());
         }       
-        route_render_info_by_route_name[route_name] = {all_stops_coords_in_route, route_info->is_roundtrip};
+        route_render_info_by_route_name.emplace_back(route_info->name, InfoForRenderRoute{all_stops_coords_in_route, 
+                                                                                          route_info->is_roundtrip});
     }
     
-    std::map<std::string_view, svg::Point> coords_of_stop_in_route_by_stop_name;
-    for (const auto [stop_name, stop_info] : all_stops) {
-        for (const auto [route_name, route_info] : all_routes) {
-            if (std::count(route_info->stops.begin(), route_info->stops.end(), stop_name)) {
-                coords_of_stop_in_route_by_stop_name[stop_name] = proj_(stop_info->coordinates);
-                break;
-            }
+    std::vector<std::pair<std::string_view, svg::Point>> coords_of_stop_in_route_by_stop_name;
+    for (const transport::Stop* stop_info : sorted_stops) {
+        const auto buses = snapshot.GetBusesByStop(stop_info->id);
+        if (buses.begin() != buses.end()) {
+            coords_of_stop_in_route_by_stop_name.emplace_back(stop_info->name, proj_(stop_info->coordinates));
         }
     }
             
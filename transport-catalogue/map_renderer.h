@@ -1,5 +1,6 @@
 #pragma once
 
+#include "catalogue_snapshot.h"
 #include "domain.h"
 #include "geo.h"
 #include "svg.h"
@@ -7,9 +8,8 @@
 #include <algorithm>
 #include <cstdlib>
 #include <iostream>
-#include <map>
 #include <optional>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
 inline const double EPSILON = 1e-6;
@@ -96,20 +96,19 @@ class MapRenderer {
 public:
     void SetSettings(RenderSettings settings);
     
-    void AddAllRoutesLines(const std::map<std::string_view, InfoForRenderRoute>& route_render_info_by_route_name, 
+    void AddAllRoutesLines(const std::vector<std::pair<std::string_view, InfoForRenderRoute>>& route_render_info_by_route_name, 
                                  svg::Document& document) const;
     
-    void AddAllRoutesTexts(const std::map<std::string_view, InfoForRenderRoute>& route_render_info_by_route_name, 
+    void AddAllRoutesTexts(const std::vector<std::pair<std::string_view, InfoForRenderRoute>>& route_render_info_by_route_name, 
                                  svg::Document& document) const;
     
-    void AddAllStopsPoints(const std::map<std::string_view, svg::Point>& coords_of_stop_in_route_by_stop_name,
+    void AddAllStopsPoints(const std::vector<std::pair<std::string_view, svg::Point>>& coords_of_stop_in_route_by_stop_name,
                                  svg::Document& document) const;
     
-    void AddAllStopsTexts(const std::map<std::string_view, svg::Point>& coords_of_stop_in_route_by_stop_name,
+    void AddAllStopsTexts(const std::vector<std::pair<std::string_view, svg::Point>>& coords_of_stop_in_route_by_stop_name,
                                 svg::Document& document) const;
     
-    svg::Document MakeSvgDocument(const std::unordered_map<std::string_view, const transport::Stop*>& all_stops,
-                                  const std::unordered_map<std::string_view, const transport::Route*>& all_routes) const;
+    svg::Document MakeSvgDocument(const transport::CatalogueSnapshot& snapshot) const;
     
 private:    
     RenderSettings settings_;
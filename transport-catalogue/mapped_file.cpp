@@ -0,0 +1,47 @@
+#include "mapped_file.h"
+
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std::literals;
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        throw std::runtime_error("Can't open file "s + path.string());
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1) {
+        close(fd);
+        throw std::runtime_error("Can't get size of file "s + path.string());
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+    if (size_ > 0) {
+        data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    // Отображение остаётся валидным и после закрытия дескриптора
+    close(fd);
+    if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        throw std::runtime_error("Can't map file "s + path.string());
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (data_) {
+        munmap(data_, size_);
+    }
+}
+
+const char* MappedFile::GetData() const {
+    return static_cast<const char*>(data_);
+}
+
+size_t MappedFile::GetSize() const {
+    return size_;
+}
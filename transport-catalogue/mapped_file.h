@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdlib>
+#include <filesystem>
+
+// Файл, отображённый в память только для чтения
+class MappedFile {
+public:
+    explicit MappedFile(const std::filesystem::path& path);
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    ~MappedFile();
+    
+    const char* GetData() const;
+    size_t GetSize() const;
+    
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
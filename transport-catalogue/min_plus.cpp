@@ -0,0 +1,176 @@
+#include "min_plus.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MIN_PLUS_X86
+#include <immintrin.h>
+#endif
+
+namespace graph {
+
+namespace {
+
+template <typename Weight>
+using RelaxRowFunction = void (*)(Weight, const Weight*, const uint32_t*, Weight*, uint32_t*, size_t);
+
+#ifdef MIN_PLUS_X86
+
+__attribute__((target("sse2")))
+void RelaxRowMinPlusSse2(double weight_from_through, const double* weights_through, const uint32_t* prev_edges_through,
+                         double* weights_from, uint32_t* prev_edges_from, size_t count) {
+    const __m128d broadcast_weight = _mm_set1_pd(weight_from_through);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const __m128d candidate = _mm_add_pd(broadcast_weight, _mm_loadu_pd(weights_through + i));
+        const __m128d current = _mm_loadu_pd(weights_from + i);
+        const __m128d mask = _mm_cmplt_pd(candidate, current);
+        _mm_storeu_pd(weights_from + i, _mm_or_pd(_mm_and_pd(mask, candidate), _mm_andnot_pd(mask, current)));
+
+        // Маски 64-битных полос сжимаем до двух 32-битных
+        const __m128i mask_32 = _mm_shuffle_epi32(_mm_castpd_si128(mask), _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128i prev_current = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(prev_edges_from + i));
+        const __m128i prev_candidate = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(prev_edges_through + i));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(prev_edges_from + i),
+                         _mm_or_si128(_mm_and_si128(mask_32, prev_candidate), _mm_andnot_si128(mask_32, prev_current)));
+    }
+    RelaxRowMinPlusScalar(weight_from_through, weights_through + i, prev_edges_through + i,
+                          weights_from + i, prev_edges_from + i, count - i);
+}
+
+__attribute__((target("avx2")))
+void RelaxRowMinPlusAvx2(double weight_from_through, const double* weights_through, const uint32_t* prev_edges_through,
+                         double* weights_from, uint32_t* prev_edges_from, size_t count) {
+    const __m256d broadcast_weight = _mm256_set1_pd(weight_from_through);
+    const __m256i even_lanes = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256d candidate = _mm256_add_pd(broadcast_weight, _mm256_loadu_pd(weights_through + i));
+        const __m256d current = _mm256_loadu_pd(weights_from + i);
+        const __m256d mask = _mm256_cmp_pd(candidate, current, _CMP_LT_OQ);
+        _mm256_storeu_pd(weights_from + i, _mm256_blendv_pd(current, candidate, mask));
+
+        const __m128i mask_32 = _mm256_castsi256_si128(
+                                _mm256_permutevar8x32_epi32(_mm256_castpd_si256(mask), even_lanes));
+        const __m128i prev_current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges_from + i));
+        const __m128i prev_candidate = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges_through + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(prev_edges_from + i),
+                         _mm_blendv_epi8(prev_current, prev_candidate, mask_32));
+    }
+    RelaxRowMinPlusScalar(weight_from_through, weights_through + i, prev_edges_through + i,
+                          weights_from + i, prev_edges_from + i, count - i);
+}
+
+__attribute__((target("sse2")))
+void RelaxRowMinPlusSse2(int32_t weight_from_through, const int32_t* weights_through, const uint32_t* prev_edges_through,
+                         int32_t* weights_from, uint32_t* prev_edges_from, size_t count) {
+    const __m128i broadcast_weight = _mm_set1_epi32(weight_from_through);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i candidate = _mm_add_epi32(broadcast_weight,
+                                                _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights_through + i)));
+        const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights_from + i));
+        const __m128i mask = _mm_cmplt_epi32(candidate, current);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(weights_from + i),
+                         _mm_or_si128(_mm_and_si128(mask, candidate), _mm_andnot_si128(mask, current)));
+
+        // Полосы весов и рёбер одной ширины, маска подходит обоим без перестановок
+        const __m128i prev_current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges_from + i));
+        const __m128i prev_candidate = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges_through + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(prev_edges_from + i),
+                         _mm_or_si128(_mm_and_si128(mask, prev_candidate), _mm_andnot_si128(mask, prev_current)));
+    }
+    RelaxRowMinPlusScalar(weight_from_through, weights_through + i, prev_edges_through + i,
+                          weights_from + i, prev_edges_from + i, count - i);
+}
+
+__attribute__((target("avx2")))
+void RelaxRowMinPlusAvx2(int32_t weight_from_through, const int32_t* weights_through, const uint32_t* prev_edges_through,
+                         int32_t* weights_from, uint32_t* prev_edges_from, size_t count) {
+    const __m256i broadcast_weight = _mm256_set1_epi32(weight_from_through);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i candidate = _mm256_add_epi32(broadcast_weight,
+                                                   _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights_through + i)));
+        const __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights_from + i));
+        const __m256i mask = _mm256_cmpgt_epi32(current, candidate);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(weights_from + i), _mm256_min_epi32(current, candidate));
+
+        const __m256i prev_current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_edges_from + i));
+        const __m256i prev_candidate = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_edges_through + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(prev_edges_from + i),
+                            _mm256_blendv_epi8(prev_current, prev_candidate, mask));
+    }
+    RelaxRowMinPlusScalar(weight_from_through, weights_through + i, prev_edges_through + i,
+                          weights_from + i, prev_edges_from + i, count - i);
+}
+
+#endif
+
+InstructionSet DetectInstructionSet() {
+#ifdef MIN_PLUS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return InstructionSet::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return InstructionSet::SSE2;
+    }
+#endif
+    return InstructionSet::SCALAR;
+}
+
+template <typename Weight>
+RelaxRowFunction<Weight> SelectRelaxRowFunction(InstructionSet instruction_set) {
+    switch (instruction_set) {
+#ifdef MIN_PLUS_X86
+        case InstructionSet::AVX2:
+            return RelaxRowMinPlusAvx2;
+        case InstructionSet::SSE2:
+            return RelaxRowMinPlusSse2;
+#endif
+        default:
+            return RelaxRowMinPlusScalar;
+    }
+}
+
+}  // namespace
+
+InstructionSet GetMinPlusInstructionSet() {
+    static const InstructionSet instruction_set = DetectInstructionSet();
+    return instruction_set;
+}
+
+void RelaxRowMinPlus(double weight_from_through, const double* weights_through, const uint32_t* prev_edges_through,
+                     double* weights_from, uint32_t* prev_edges_from, size_t count) {
+    static const RelaxRowFunction<double> relax_row = SelectRelaxRowFunction<double>(GetMinPlusInstructionSet());
+    relax_row(weight_from_through, weights_through, prev_edges_through, weights_from, prev_edges_from, count);
+}
+
+void RelaxRowMinPlus(int32_t weight_from_through, const int32_t* weights_through, const uint32_t* prev_edges_through,
+                     int32_t* weights_from, uint32_t* prev_edges_from, size_t count) {
+    static const RelaxRowFunction<int32_t> relax_row = SelectRelaxRowFunction<int32_t>(GetMinPlusInstructionSet());
+    relax_row(weight_from_through, weights_through, prev_edges_through, weights_from, prev_edges_from, count);
+}
+
+void RelaxRowMinPlusScalar(double weight_from_through, const double* weights_through, const uint32_t* prev_edges_through,
+                           double* weights_from, uint32_t* prev_edges_from, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const double candidate_weight = weight_from_through + weights_through[i];
+        if (candidate_weight < weights_from[i]) {
+            weights_from[i] = candidate_weight;
+            prev_edges_from[i] = prev_edges_through[i];
+        }
+    }
+}
+
+void RelaxRowMinPlusScalar(int32_t weight_from_through, const int32_t* weights_through, const uint32_t* prev_edges_through,
+                           int32_t* weights_from, uint32_t* prev_edges_from, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const int32_t candidate_weight = weight_from_through + weights_through[i];
+        if (candidate_weight < weights_from[i]) {
+            weights_from[i] = candidate_weight;
+            prev_edges_from[i] = prev_edges_through[i];
+        }
+    }
+}
+
+}  // namespace graph
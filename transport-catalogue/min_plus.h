@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace graph {
+
+enum class InstructionSet {
+    SCALAR,
+    SSE2,
+    AVX2,
+};
+
+InstructionSet GetMinPlusInstructionSet();
+
+// Для каждого i: если weight_from_through + weights_through[i] < weights_from[i],
+// записывает сумму в weights_from[i], а prev_edges_through[i] — в prev_edges_from[i]
+void RelaxRowMinPlus(double weight_from_through, const double* weights_through, const uint32_t* prev_edges_through,
+                     double* weights_from, uint32_t* prev_edges_from, size_t count);
+
+void RelaxRowMinPlusScalar(double weight_from_through, const double* weights_through, const uint32_t* prev_edges_through,
+                           double* weights_from, uint32_t* prev_edges_from, size_t count);
+
+// То же для целых весов: в SIMD-регистр помещается вдвое больше элементов, чем для double
+void RelaxRowMinPlus(int32_t weight_from_through, const int32_t* weights_through, const uint32_t* prev_edges_through,
+                     int32_t* weights_from, uint32_t* prev_edges_from, size_t count);
+
+void RelaxRowMinPlusScalar(int32_t weight_from_through, const int32_t* weights_through, const uint32_t* prev_edges_through,
+                           int32_t* weights_from, uint32_t* prev_edges_from, size_t count);
+
+}  // namespace graph
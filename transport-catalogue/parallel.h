@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+inline size_t GetHardwareThreadsCount() {
+    return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+class Barrier {
+public:
+    explicit Barrier(size_t threads_count)
+        : threads_count_(threads_count) {
+    }
+
+    void ArriveAndWait() {
+        std::unique_lock lock(mutex_);
+        const size_t generation = generation_;
+        if (++arrived_count_ == threads_count_) {
+            arrived_count_ = 0;
+            ++generation_;
+            condition_.notify_all();
+            return;
+        }
+        condition_.wait(lock, [this, generation] {
+            return generation != generation_;
+        });
+    }
+
+private:
+    const size_t threads_count_;
+    size_t arrived_count_ = 0;
+    size_t generation_ = 0;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+};
+
+template <typename Function>
+void RunInThreads(size_t threads_count, Function function) {
+    if (threads_count <= 1) {
+        function(0);
+        return;
+    }
+    std::vector<std::exception_ptr> exceptions(threads_count);
+    std::vector<std::thread> threads;
+    threads.reserve(threads_count - 1);
+    for (size_t thread_index = 1; thread_index < threads_count; ++thread_index) {
+        threads.emplace_back([&function, &exceptions, thread_index] {
+            try {
+                function(thread_index);
+            } catch (...) {
+                exceptions[thread_index] = std::current_exception();
+            }
+        });
+    }
+    try {
+        function(0);
+    } catch (...) {
+        exceptions[0] = std::current_exception();
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (const std::exception_ptr& exception : exceptions) {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+}
+
+}  // namespace parallel
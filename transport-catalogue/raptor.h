@@ -0,0 +1,296 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace transport {
+
+// Маршруты в плоских массивах: остановки маршрута route занимают в stops позиции
+// с offsets[route] по offsets[route + 1] - 1, а distances — расстояние от начала
+// маршрута до каждой из них. Направления некольцевого автобуса — разные маршруты
+struct RaptorRoutes {
+    std::vector<uint32_t> offsets = {0};
+    std::vector<uint32_t> stops = {};
+    std::vector<uint64_t> distances = {};
+};
+
+// RAPTOR без расписаний: раунд k находит лучшие поездки ровно с k посадками,
+// один раз проходя по массиву остановок каждого маршрута, на котором есть улучшенная
+// в прошлом раунде остановка. Никакой предобработки, кроме индекса «остановка — маршруты»
+template <typename Weight>
+class Raptor {
+public:
+    // Вес поездки на расстояние distance вместе с ожиданием посадки
+    using LegWeight = std::function<Weight(uint64_t distance)>;
+
+    // Поездка по маршруту route между его позициями board_position и alight_position
+    struct Leg {
+        uint32_t route;
+        uint32_t board_position;
+        uint32_t alight_position;
+        Weight weight;
+    };
+
+    struct Journey {
+        Weight weight;
+        std::vector<Leg> legs;
+    };
+
+    Raptor(size_t stop_count, RaptorRoutes routes, LegWeight leg_weight);
+
+    // Самый быстрый путь; legs очищается, его память переиспользуется
+    std::optional<Weight> BuildJourney(uint32_t from, uint32_t to, std::vector<Leg>& legs) const;
+    // Пути, оптимальные по Парето по весу и числу посадок, по возрастанию числа посадок
+    std::vector<Journey> BuildParetoJourneys(uint32_t from, uint32_t to) const;
+    // Веса самых быстрых путей из from в targets; пустое значение — пути нет
+    std::vector<std::optional<Weight>> BuildWeightsFrom(uint32_t from, const std::vector<uint32_t>& targets) const;
+    // Остановки, путь до которых не тяжелее max_weight, по возрастанию веса пути;
+    // метки тяжелее max_weight не ставятся, поэтому раунды быстро заканчиваются
+    void FindReachable(uint32_t from, Weight max_weight, std::vector<std::pair<uint32_t, Weight>>& stops) const;
+
+    const RaptorRoutes& GetRoutes() const;
+
+private:
+    static constexpr uint32_t NO_POSITION = std::numeric_limits<uint32_t>::max();
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight UNREACHABLE_WEIGHT = std::numeric_limits<Weight>::has_infinity
+                                                 ? std::numeric_limits<Weight>::infinity()
+                                                 : std::numeric_limits<Weight>::max() / 2;
+
+    // Лучший вес не более чем с round посадками и последняя поездка, давшая его в раунде round
+    struct Label {
+        Weight weight;
+        uint32_t round;
+        Leg leg;
+    };
+
+    struct RouteStop {
+        uint32_t route;
+        uint32_t position;
+    };
+
+    void Run(uint32_t from, std::optional<uint32_t> target, Weight max_weight = UNREACHABLE_WEIGHT) const;
+    void ScanRoute(uint32_t route, size_t round, std::optional<uint32_t> target, Weight max_weight) const;
+    const Label& GetLabel(size_t round, uint32_t stop) const;
+    void ExtractLegs(uint32_t to, size_t round, std::vector<Leg>& legs) const;
+    void CheckStop(uint32_t stop) const;
+
+    const size_t stop_count_;
+    const RaptorRoutes routes_;
+    const LegWeight leg_weight_;
+    std::vector<size_t> route_stop_offsets_;
+    std::vector<RouteStop> route_stops_;
+
+    mutable std::mutex search_mutex_;
+    mutable std::vector<Label> labels_;
+    mutable size_t round_count_ = 0;
+    mutable std::vector<uint32_t> marked_stops_;
+    mutable std::vector<bool> is_marked_;
+    mutable std::vector<uint32_t> queued_routes_;
+    mutable std::vector<uint32_t> first_marked_positions_;
+};
+
+template <typename Weight>
+Raptor<Weight>::Raptor(size_t stop_count, RaptorRoutes routes, LegWeight leg_weight)
+    : stop_count_(stop_count)
+    , routes_(std::move(routes))
+    , leg_weight_(std::move(leg_weight))
+    , route_stop_offsets_(stop_count + 1, 0)
+    , is_marked_(stop_count, false)
+{
+    if (routes_.offsets.empty() || routes_.offsets.back() != routes_.stops.size()
+        || routes_.stops.size() != routes_.distances.size()
+        || !std::is_sorted(routes_.offsets.begin(), routes_.offsets.end())) {
+        throw std::invalid_argument("Inconsistent RAPTOR routes");
+    }
+    const size_t route_count = routes_.offsets.size() - 1;
+    for (const uint32_t stop : routes_.stops) {
+        CheckStop(stop);
+        ++route_stop_offsets_[stop + 1];
+    }
+    for (size_t stop = 0; stop < stop_count; ++stop) {
+        route_stop_offsets_[stop + 1] += route_stop_offsets_[stop];
+    }
+    route_stops_.resize(routes_.stops.size());
+    std::vector<size_t> next_route_stop_indices(route_stop_offsets_.begin(), route_stop_offsets_.end() - 1);
+    for (uint32_t route = 0; route < route_count; ++route) {
+        for (uint32_t index = routes_.offsets[route]; index < routes_.offsets[route + 1]; ++index) {
+            route_stops_[next_route_stop_indices[routes_.stops[index]]++] = {route, index - routes_.offsets[route]};
+        }
+    }
+    first_marked_positions_.assign(route_count, NO_POSITION);
+}
+
+template <typename Weight>
+std::optional<Weight> Raptor<Weight>::BuildJourney(uint32_t from, uint32_t to, std::vector<Leg>& legs) const {
+    CheckStop(from);
+    CheckStop(to);
+    legs.clear();
+    std::lock_guard guard(search_mutex_);
+    Run(from, to);
+    const size_t last_round = round_count_ - 1;
+    if (GetLabel(last_round, to).weight == UNREACHABLE_WEIGHT) {
+        return std::nullopt;
+    }
+    ExtractLegs(to, last_round, legs);
+    return GetLabel(last_round, to).weight;
+}
+
+template <typename Weight>
+std::vector<typename Raptor<Weight>::Journey> Raptor<Weight>::BuildParetoJourneys(uint32_t from, uint32_t to) const {
+    CheckStop(from);
+    CheckStop(to);
+    std::vector<Journey> journeys;
+    std::lock_guard guard(search_mutex_);
+    Run(from, to);
+    // Метка цели меняется только в раундах, где путь с большим числом посадок строго быстрее
+    for (size_t round = 0; round < round_count_; ++round) {
+        const Label& label = GetLabel(round, to);
+        if (label.weight != UNREACHABLE_WEIGHT && label.round == round) {
+            journeys.push_back({label.weight, {}});
+            ExtractLegs(to, round, journeys.back().legs);
+        }
+    }
+    return journeys;
+}
+
+template <typename Weight>
+std::vector<std::optional<Weight>> Raptor<Weight>::BuildWeightsFrom(uint32_t from,
+                                                                    const std::vector<uint32_t>& targets) const {
+    CheckStop(from);
+    for (const uint32_t target : targets) {
+        CheckStop(target);
+    }
+    std::vector<std::optional<Weight>> weights(targets.size());
+    std::lock_guard guard(search_mutex_);
+    Run(from, std::nullopt);
+    for (size_t target_index = 0; target_index < targets.size(); ++target_index) {
+        const Weight weight = GetLabel(round_count_ - 1, targets[target_index]).weight;
+        if (weight != UNREACHABLE_WEIGHT) {
+            weights[target_index] = weight;
+        }
+    }
+    return weights;
+}
+
+template <typename Weight>
+void Raptor<Weight>::FindReachable(uint32_t from, Weight max_weight, std::vector<std::pair<uint32_t, Weight>>& stops) const {
+    CheckStop(from);
+    stops.clear();
+    std::lock_guard guard(search_mutex_);
+    Run(from, std::nullopt, max_weight);
+    for (uint32_t stop = 0; stop < stop_count_; ++stop) {
+        const Weight weight = GetLabel(round_count_ - 1, stop).weight;
+        if (weight != UNREACHABLE_WEIGHT) {
+            stops.push_back({stop, weight});
+        }
+    }
+    std::sort(stops.begin(), stops.end(), [](const auto& lhs, const auto& rhs) {
+        return std::pair(lhs.second, lhs.first) < std::pair(rhs.second, rhs.first);
+    });
+}
+
+template <typename Weight>
+const RaptorRoutes& Raptor<Weight>::GetRoutes() const {
+    return routes_;
+}
+
+template <typename Weight>
+void Raptor<Weight>::Run(uint32_t from, std::optional<uint32_t> target, Weight max_weight) const {
+    labels_.assign(stop_count_, Label{UNREACHABLE_WEIGHT, 0, {}});
+    labels_[from].weight = ZERO_WEIGHT;
+    round_count_ = 1;
+    marked_stops_.assign(1, from);
+    is_marked_[from] = true;
+    while (!marked_stops_.empty()) {
+        // Метки раунда начинаются с меток прошлого: путь с меньшим числом посадок тоже годится
+        const size_t round = round_count_++;
+        labels_.resize(round_count_ * stop_count_);
+        std::copy(labels_.begin() + (round - 1) * stop_count_, labels_.begin() + round * stop_count_,
+                  labels_.begin() + round * stop_count_);
+        for (const uint32_t stop : marked_stops_) {
+            is_marked_[stop] = false;
+            for (size_t index = route_stop_offsets_[stop]; index < route_stop_offsets_[stop + 1]; ++index) {
+                const auto [route, position] = route_stops_[index];
+                if (first_marked_positions_[route] == NO_POSITION) {
+                    queued_routes_.push_back(route);
+                }
+                first_marked_positions_[route] = std::min(first_marked_positions_[route], position);
+            }
+        }
+        marked_stops_.clear();
+        for (const uint32_t route : queued_routes_) {
+            ScanRoute(route, round, target, max_weight);
+            first_marked_positions_[route] = NO_POSITION;
+        }
+        queued_routes_.clear();
+    }
+}
+
+template <typename Weight>
+void Raptor<Weight>::ScanRoute(uint32_t route, size_t round, std::optional<uint32_t> target, Weight max_weight) const {
+    const uint32_t* stops = routes_.stops.data() + routes_.offsets[route];
+    const uint64_t* distances = routes_.distances.data() + routes_.offsets[route];
+    const uint32_t stop_count = routes_.offsets[route + 1] - routes_.offsets[route];
+    Label* labels = labels_.data() + round * stop_count_;
+    const Label* previous_labels = labels - stop_count_;
+    const Weight boarding_weight = leg_weight_(0);
+
+    uint32_t board_position = NO_POSITION;
+    for (uint32_t position = first_marked_positions_[route]; position < stop_count; ++position) {
+        const uint32_t stop = stops[position];
+        Weight arrival_weight = UNREACHABLE_WEIGHT;
+        if (board_position != NO_POSITION) {
+            const Weight leg_weight = leg_weight_(distances[position] - distances[board_position]);
+            arrival_weight = previous_labels[stops[board_position]].weight + leg_weight;
+            // Метка, не лучшая уже найденного пути до цели, ничего не улучшит
+            const Weight bound = target ? std::min(labels[stop].weight, labels[*target].weight) : labels[stop].weight;
+            if (arrival_weight < bound && !(max_weight < arrival_weight)) {
+                labels[stop] = {arrival_weight, static_cast<uint32_t>(round), {route, board_position, position, leg_weight}};
+                if (!is_marked_[stop]) {
+                    is_marked_[stop] = true;
+                    marked_stops_.push_back(stop);
+                }
+            }
+        }
+        // Пересадка на этот же маршрут здесь выгоднее, если с её ожиданием
+        // автобус окажется здесь раньше, чем при посадке на прежней остановке
+        const Weight previous_weight = previous_labels[stop].weight;
+        if (previous_weight != UNREACHABLE_WEIGHT && previous_weight + boarding_weight < arrival_weight) {
+            board_position = position;
+        }
+    }
+}
+
+template <typename Weight>
+const typename Raptor<Weight>::Label& Raptor<Weight>::GetLabel(size_t round, uint32_t stop) const {
+    return labels_[round * stop_count_ + stop];
+}
+
+template <typename Weight>
+void Raptor<Weight>::ExtractLegs(uint32_t to, size_t round, std::vector<Leg>& legs) const {
+    uint32_t stop = to;
+    for (const Label* label = &GetLabel(round, stop); label->round > 0;) {
+        const Leg& leg = label->leg;
+        legs.push_back(leg);
+        stop = routes_.stops[routes_.offsets[leg.route] + leg.board_position];
+        label = &GetLabel(label->round - 1, stop);
+    }
+    std::reverse(legs.begin(), legs.end());
+}
+
+template <typename Weight>
+void Raptor<Weight>::CheckStop(uint32_t stop) const {
+    if (stop >= stop_count_) {
+        throw std::out_of_range("Stop id is out of range");
+    }
+}
+
+}  // namespace transport
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Дейкстра из одной вершины, не выходящая за вес max_weight: вершины тяжелее
+// в очередь не попадают, и поиск заканчивается, как только очередь пуста.
+// Массивы поиска переживают запросы и подстраиваются под рост графа
+template <typename Weight>
+class ReachabilitySearch {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    explicit ReachabilitySearch(const Graph& graph);
+
+    // Вершины с весом кратчайшего пути из from не больше max_weight в порядке
+    // возрастания веса; vertices очищается, его память переиспользуется
+    void FindReachable(VertexId from, Weight max_weight, std::vector<std::pair<VertexId, Weight>>& vertices) const;
+
+private:
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight UNREACHABLE_WEIGHT = std::numeric_limits<Weight>::has_infinity
+                                                 ? std::numeric_limits<Weight>::infinity()
+                                                 : std::numeric_limits<Weight>::max() / 2;
+
+    const Graph& graph_;
+    mutable std::mutex search_mutex_;
+    mutable std::vector<Weight> weights_;
+    mutable std::vector<VertexId> touched_;
+    mutable MinQueue<std::pair<Weight, VertexId>> queue_;
+};
+
+template <typename Weight>
+ReachabilitySearch<Weight>::ReachabilitySearch(const Graph& graph)
+    : graph_(graph) {
+}
+
+template <typename Weight>
+void ReachabilitySearch<Weight>::FindReachable(VertexId from, Weight max_weight,
+                                               std::vector<std::pair<VertexId, Weight>>& vertices) const {
+    if (from >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    vertices.clear();
+    std::lock_guard guard(search_mutex_);
+    for (const VertexId vertex : touched_) {
+        if (vertex < weights_.size()) {
+            weights_[vertex] = UNREACHABLE_WEIGHT;
+        }
+    }
+    touched_.clear();
+    queue_.clear();
+    weights_.resize(graph_.GetVertexCount(), UNREACHABLE_WEIGHT);
+
+    weights_[from] = ZERO_WEIGHT;
+    touched_.push_back(from);
+    queue_.push({ZERO_WEIGHT, from});
+    while (!queue_.empty()) {
+        const auto [weight, vertex] = queue_.top();
+        queue_.pop();
+        if (weights_[vertex] < weight) {
+            continue;
+        }
+        vertices.push_back({vertex, weight});
+        graph_.ForEachIncidentEdge(vertex, [&, weight = weight](EdgeId, VertexId to, Weight edge_weight) {
+            const Weight candidate_weight = weight + edge_weight;
+            Weight& weight_to = weights_[to];
+            if (candidate_weight < weight_to && !(max_weight < candidate_weight)) {
+                if (weight_to == UNREACHABLE_WEIGHT) {
+                    touched_.push_back(to);
+                }
+                weight_to = candidate_weight;
+                queue_.push({candidate_weight, to});
+            }
+        });
+    }
+}
+
+}  // namespace graph
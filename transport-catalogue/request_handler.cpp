@@ -10,19 +10,49 @@ std::optional<transport::TransportCatalogue::RouteInfo> RequestHandler::GetBusSt
     return bus_stat;
 }
 
-const std::unordered_set<std::string_view>* RequestHandler::GetBusesByStop(const std::string_view& stop_name) const {
-    return catalogue_.GetRoutesThroughStop(stop_name);
+std::optional<transport::CatalogueSnapshot::BusesRange> RequestHandler::GetBusesByStop(const std::string_view& stop_name) const {
+    return snapshot_.GetBusesByStop(stop_name);
 }
 
 svg::Document RequestHandler::RenderMap() const {
-    return renderer_.MakeSvgDocument(catalogue_.GetAllStops(), catalogue_.GetAllRoutes());
+    return renderer_.MakeSvgDocument(snapshot_);
 }
 
 void RequestHandler::UpdateTransportRouterData() {
     router_.UploadTransportData(catalogue_);
 }
 
+void RequestHandler::UpdateTransportRouterRoute(std::string_view route_name) {
+    snapshot_ = transport::CatalogueSnapshot(catalogue_);
+    router_.UpdateRoute(catalogue_, route_name);
+}
+
+void RequestHandler::UpdateTransportRouterDistance(std::string_view stop_from, std::string_view stop_to) {
+    router_.UpdateDistance(catalogue_, stop_from, stop_to);
+}
+
 std::optional<transport::PathInfo> RequestHandler::GetPathBetweenTwoStops(std::string_view stop_from, 
                                                                           std::string_view stop_to) const {
     return router_.BuildPath(stop_from, stop_to);
 }
+
+bool RequestHandler::GetPathBetweenTwoStops(std::string_view stop_from, std::string_view stop_to, 
+                                            transport::PathInfo& path_info) const {
+    return router_.BuildPath(stop_from, stop_to, path_info);
+}
+
+std::vector<transport::PathInfo> RequestHandler::GetParetoPathsBetweenTwoStops(std::string_view stop_from, 
+                                                                               std::string_view stop_to) const {
+    return router_.BuildParetoPaths(stop_from, stop_to);
+}
+
+std::vector<transport::ReachableStop> RequestHandler::GetReachableStops(std::string_view stop_from, 
+                                                                       double max_time) const {
+    return router_.BuildReachableStops(stop_from, max_time);
+}
+
+transport::RouteMatrix RequestHandler::GetRouteMatrix(const std::vector<std::string_view>& stops_from, 
+                                                      const std::vector<std::string_view>& stops_to, 
+                                                      bool with_itineraries) const {
+    return router_.BuildRouteMatrix(stops_from, stops_to, with_itineraries);
+}
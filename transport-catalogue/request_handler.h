@@ -1,5 +1,6 @@
 #pragma once
 
+#include "catalogue_snapshot.h"
 #include "map_renderer.h"
 #include "transport_catalogue.h"
 #include "transport_router.h"
@@ -9,21 +10,35 @@
 class RequestHandler {
 public:
     RequestHandler(const transport::TransportCatalogue& catalogue, const MapRenderer& renderer, transport::TransportRouter& router)
-        : catalogue_(catalogue), renderer_(renderer), router_(router) {
+        : catalogue_(catalogue), snapshot_(catalogue), renderer_(renderer), router_(router) {
     }
     
     std::optional<transport::TransportCatalogue::RouteInfo> GetBusStat(const std::string_view& bus_name) const;
 
-    const std::unordered_set<std::string_view>* GetBusesByStop(const std::string_view& stop_name) const;
+    // Автобусы остановки по алфавиту, nullopt — остановки нет
+    std::optional<transport::CatalogueSnapshot::BusesRange> GetBusesByStop(const std::string_view& stop_name) const;
 
     svg::Document RenderMap() const;
     
     void UpdateTransportRouterData();
     
+    // Сообщают маршрутизатору об изменении маршрута или расстояния в каталоге;
+    // при изменении маршрута заново строится и снимок каталога
+    void UpdateTransportRouterRoute(std::string_view route_name);
+    void UpdateTransportRouterDistance(std::string_view stop_from, std::string_view stop_to);
+    
     std::optional<transport::PathInfo> GetPathBetweenTwoStops(std::string_view stop_from, std::string_view stop_to) const;
+    bool GetPathBetweenTwoStops(std::string_view stop_from, std::string_view stop_to, transport::PathInfo& path_info) const;
+    std::vector<transport::PathInfo> GetParetoPathsBetweenTwoStops(std::string_view stop_from, std::string_view stop_to) const;
+    
+    std::vector<transport::ReachableStop> GetReachableStops(std::string_view stop_from, double max_time) const;
+    
+    transport::RouteMatrix GetRouteMatrix(const std::vector<std::string_view>& stops_from, 
+                                          const std::vector<std::string_view>& stops_to, bool with_itineraries) const;
     
 private:
     const transport::TransportCatalogue& catalogue_;
+    transport::CatalogueSnapshot snapshot_;
     const MapRenderer& renderer_;
     transport::TransportRouter& router_;
 };
@@ -0,0 +1,119 @@
+#include "road_distances.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace transport {
+
+namespace {
+
+uint64_t MakePairKey(StopId stop_from, StopId stop_to) {
+    return (uint64_t{stop_from} << 32) | stop_to;
+}
+
+} // namespace
+
+RoadDistances::RoadDistances(size_t stop_count, std::vector<Entry> entries)
+    : offsets_(stop_count + 1, 0) {
+    for (const Entry& entry : entries) {
+        if (entry.stop_from >= stop_count || entry.stop_to >= stop_count) {
+            throw std::out_of_range("Stop id is out of range");
+        }
+        ++offsets_[entry.stop_from + 1];
+    }
+    for (size_t stop_id = 0; stop_id < stop_count; ++stop_id) {
+        offsets_[stop_id + 1] += offsets_[stop_id];
+    }
+    // Раскладка по строкам сохраняет порядок записей, поэтому после устойчивой сортировки
+    // строки последняя запись пары идёт последней
+    std::vector<Entry> sorted_entries(entries.size());
+    std::vector<uint32_t> positions(offsets_.begin(), offsets_.end() - 1);
+    for (const Entry& entry : entries) {
+        sorted_entries[positions[entry.stop_from]++] = entry;
+    }
+    entries.clear();
+    entries.shrink_to_fit();
+    stop_to_ids_.reserve(sorted_entries.size());
+    distances_.reserve(sorted_entries.size());
+    for (size_t stop_id = 0; stop_id < stop_count; ++stop_id) {
+        const auto row_begin = sorted_entries.begin() + offsets_[stop_id];
+        const auto row_end = sorted_entries.begin() + offsets_[stop_id + 1];
+        std::stable_sort(row_begin, row_end, [](const Entry& lhs, const Entry& rhs) {
+            return lhs.stop_to < rhs.stop_to;
+        });
+        offsets_[stop_id] = stop_to_ids_.size();
+        for (auto it = row_begin; it != row_end; ++it) {
+            if (std::next(it) != row_end && std::next(it)->stop_to == it->stop_to) {
+                continue;
+            }
+            stop_to_ids_.push_back(it->stop_to);
+            distances_.push_back(it->distance);
+        }
+    }
+    offsets_[stop_count] = stop_to_ids_.size();
+    stop_to_ids_.shrink_to_fit();
+    distances_.shrink_to_fit();
+}
+
+const int* RoadDistances::Find(StopId stop_from, StopId stop_to) const {
+    if (size_t{stop_from} + 1 < offsets_.size()) {
+        // Строки короткие, поэтому бинарный поиск без ветвлений по сравнениям
+        uint32_t first = offsets_[stop_from];
+        uint32_t length = offsets_[stop_from + 1] - first;
+        if (length > 0) {
+            while (length > 1) {
+                const uint32_t half = length / 2;
+                first += (stop_to_ids_[first + half - 1] < stop_to) * half;
+                length -= half;
+            }
+            if (stop_to_ids_[first] == stop_to) {
+                return &distances_[first];
+            }
+        }
+    }
+    if (added_distances_.empty()) {
+        return nullptr;
+    }
+    const auto it = added_distances_.find(MakePairKey(stop_from, stop_to));
+    return it != added_distances_.end() ? &it->second : nullptr;
+}
+
+int* RoadDistances::Find(StopId stop_from, StopId stop_to) {
+    return const_cast<int*>(static_cast<const RoadDistances&>(*this).Find(stop_from, stop_to));
+}
+
+void RoadDistances::Insert(StopId stop_from, StopId stop_to, int distance) {
+    if (int* known_distance = Find(stop_from, stop_to)) {
+        *known_distance = distance;
+        return;
+    }
+    added_distances_.emplace(MakePairKey(stop_from, stop_to), distance);
+}
+
+std::vector<RoadDistances::Entry> RoadDistances::GetEntries() const {
+    std::vector<Entry> entries;
+    entries.reserve(GetEntryCount());
+    for (size_t stop_id = 0; stop_id + 1 < offsets_.size(); ++stop_id) {
+        for (uint32_t index = offsets_[stop_id]; index < offsets_[stop_id + 1]; ++index) {
+            entries.push_back({static_cast<StopId>(stop_id), stop_to_ids_[index], distances_[index]});
+        }
+    }
+    // Пар из хеш-таблицы нет в списках, поэтому порядок между ними не важен
+    for (const auto [key, distance] : added_distances_) {
+        entries.push_back({static_cast<StopId>(key >> 32), static_cast<StopId>(key), distance});
+    }
+    return entries;
+}
+
+size_t RoadDistances::GetEntryCount() const {
+    return stop_to_ids_.size() + added_distances_.size();
+}
+
+size_t RoadDistances::GetMemoryUsage() const {
+    return offsets_.capacity() * sizeof(uint32_t) + stop_to_ids_.capacity() * sizeof(StopId)
+           + distances_.capacity() * sizeof(int)
+           + added_distances_.bucket_count() * sizeof(void*)
+           + added_distances_.size() * (sizeof(std::pair<const uint64_t, int>) + 2 * sizeof(void*));
+}
+
+} // namespace transport
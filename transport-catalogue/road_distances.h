@@ -0,0 +1,41 @@
+#pragma once
+
+#include "domain.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace transport {
+
+// Дорожные расстояния в виде списков смежности (CSR): у каждой остановки отсортированный
+// по номерам список соседей и расстояний до них. Строится сразу целиком; пары, добавленные
+// после построения, лежат в отдельной хеш-таблице до следующей перестройки
+class RoadDistances {
+public:
+    struct Entry {
+        StopId stop_from;
+        StopId stop_to;
+        int distance;
+    };
+
+    RoadDistances() = default;
+    // Из нескольких записей для одной пары остаётся последняя
+    RoadDistances(size_t stop_count, std::vector<Entry> entries);
+
+    const int* Find(StopId stop_from, StopId stop_to) const;
+    int* Find(StopId stop_from, StopId stop_to);
+    // Известная пара меняется на месте, новая попадает в хеш-таблицу без перестройки списков
+    void Insert(StopId stop_from, StopId stop_to, int distance);
+    std::vector<Entry> GetEntries() const;
+    size_t GetEntryCount() const;
+    size_t GetMemoryUsage() const;
+
+private:
+    std::vector<uint32_t> offsets_;
+    std::vector<StopId> stop_to_ids_;
+    std::vector<int> distances_;
+    std::unordered_map<uint64_t, int> added_distances_;
+};
+
+} // namespace transport
@@ -1,13 +1,21 @@
 #pragma once
 
 #include "graph.h"
+#include "min_plus.h"
+#include "parallel.h"
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstdint>
+#include <functional>
 #include <iterator>
+#include <limits>
+#include <numeric>
 #include <optional>
+#include <queue>
 #include <stdexcept>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -15,103 +23,501 @@
 namespace graph {
 
 template <typename Weight>
-class Router {
+struct RouteInfo {
+    Weight weight;
+    std::vector<EdgeId> edges;
+};
+
+template <typename Weight>
+using WeightsMatrix = std::vector<std::vector<std::optional<Weight>>>;
+
+// Очередь с приоритетом, наверху которой наименьший элемент. В отличие от std::priority_queue
+// её можно очистить, сохранив память, поэтому повторные поиски не выделяют память заново
+template <typename T>
+class MinQueue {
+public:
+    bool empty() const {
+        return items_.empty();
+    }
+    const T& top() const {
+        return items_.front();
+    }
+    void push(const T& item) {
+        items_.push_back(item);
+        std::push_heap(items_.begin(), items_.end(), std::greater<T>{});
+    }
+    void pop() {
+        std::pop_heap(items_.begin(), items_.end(), std::greater<T>{});
+        items_.pop_back();
+    }
+    void clear() {
+        items_.clear();
+    }
+
 private:
-    using Graph = DirectedWeightedGraph<Weight>;
+    std::vector<T> items_;
+};
 
+template <typename Weight>
+class RoutingEngine {
 public:
-    explicit Router(const Graph& graph);
+    virtual ~RoutingEngine() = default;
+
+    // Записывает рёбра кратчайшего пути в edges и возвращает его вес. Прежнее содержимое
+    // edges стирается, а память остаётся, так что повторные запросы с тем же буфером
+    // её не выделяют; пустое значение — пути нет
+    virtual std::optional<Weight> BuildRoute(VertexId from, VertexId to, std::vector<EdgeId>& edges) const = 0;
 
-    struct RouteInfo {
-        Weight weight;
+    std::optional<RouteInfo<Weight>> BuildRoute(VertexId from, VertexId to) const {
+        RouteInfo<Weight> route_info{};
+        const auto weight = BuildRoute(from, to, route_info.edges);
+        if (!weight) {
+            return std::nullopt;
+        }
+        route_info.weight = *weight;
+        return route_info;
+    }
+
+    // Веса кратчайших путей из каждой вершины sources в каждую вершину targets;
+    // по умолчанию на каждую пару строится отдельный маршрут
+    virtual WeightsMatrix<Weight> BuildWeightsMatrix(const std::vector<VertexId>& sources,
+                                                     const std::vector<VertexId>& targets) const {
+        WeightsMatrix<Weight> matrix(sources.size(), std::vector<std::optional<Weight>>(targets.size()));
         std::vector<EdgeId> edges;
-    };
+        for (size_t source_index = 0; source_index < sources.size(); ++source_index) {
+            for (size_t target_index = 0; target_index < targets.size(); ++target_index) {
+                matrix[source_index][target_index] = BuildRoute(sources[source_index], targets[target_index], edges);
+            }
+        }
+        return matrix;
+    }
 
-    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    // Граф изменился: рёбра added_edges добавлены, removed_edges удалены. Возвращает false,
+    // если движок не умеет обновляться по изменениям и его нужно построить заново
+    virtual bool UpdateEdges([[maybe_unused]] const std::vector<EdgeId>& added_edges,
+                             [[maybe_unused]] const std::vector<EdgeId>& removed_edges) {
+        return false;
+    }
+};
 
+// Номера рёбер в таблице занимают EdgeIndex: по умолчанию 32 бита, вдвое меньше EdgeId,
+// а для графа с 2^32 - 1 рёбрами и больше нужен uint64_t
+template <typename Weight, typename Index = uint32_t>
+class Router final : public RoutingEngine<Weight> {
 private:
-    struct RouteInternalData {
-        Weight weight;
-        std::optional<EdgeId> prev_edge;
-    };
-    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using EdgeIndex = Index;
+    static_assert(std::is_unsigned_v<EdgeIndex>, "Edge index should be an unsigned integer");
+
+    // Наибольшее число рёбер графа, номера которых помещаются в EdgeIndex
+    static constexpr size_t MAX_EDGE_COUNT = std::numeric_limits<EdgeIndex>::max() - 1;
+
+    // Таблица хранит пути только внутри компонент связности графа: квадрат на каждую
+    // компоненту вместо квадрата на весь граф, а пара из разных компонент недостижима сразу
+    explicit Router(const Graph& graph, size_t threads_count = 1);
+    // Готовые таблицы во внешней памяти (например, в отображённом в память снимке),
+    // которая должна жить дольше маршрутизатора; при первом обновлении они копируются.
+    // component_by_vertex — разбиение, с которым таблицы были построены
+    Router(const Graph& graph, const uint32_t* component_by_vertex, const Weight* weights, const EdgeIndex* prev_edges,
+           size_t threads_count = 1);
+
+    using RoutingEngine<Weight>::BuildRoute;
+    std::optional<Weight> BuildRoute(VertexId from, VertexId to, std::vector<EdgeId>& edges) const override;
+    WeightsMatrix<Weight> BuildWeightsMatrix(const std::vector<VertexId>& sources,
+                                             const std::vector<VertexId>& targets) const override;
+    // Строки, в дереве путей которых есть удалённое ребро, пересчитываются Дейкстрой,
+    // затем таблица релаксируется только через концы добавленных рёбер. Ребро между
+    // разными компонентами меняет разбиение, и таблицу приходится строить заново; так же
+    // и когда затронуто столько строк, что их пересчёт дороже всего Флойда–Уоршелла
+    bool UpdateEdges(const std::vector<EdgeId>& added_edges, const std::vector<EdgeId>& removed_edges) override;
+
+    const std::vector<uint32_t>& GetComponentByVertex() const;
+    size_t GetTableSize() const;
+    const Weight* GetWeights() const;
+    const EdgeIndex* GetPrevEdges() const;
+
+    // Число ячеек таблицы для разбиения component_by_vertex
+    static size_t ComputeTableSize(const uint32_t* component_by_vertex, size_t vertex_count);
+
+private:
+    static constexpr EdgeIndex NO_EDGE = std::numeric_limits<EdgeIndex>::max();
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight UNREACHABLE_WEIGHT = std::numeric_limits<Weight>::has_infinity
+                                                 ? std::numeric_limits<Weight>::infinity()
+                                                 : std::numeric_limits<Weight>::max() / 2;
+    // Компонента меньше стольких строк на поток релаксируется одним потоком без синхронизации
+    static constexpr size_t MIN_SHARED_ROWS_PER_THREAD = 64;
+    // Во сколько раз шаг Дейкстры (ребро и операция с кучей) дороже релаксации одной ячейки
+    // таблицы во Флойде–Уоршелле; замерено на графах из сотен и тысяч остановок
+    static constexpr size_t TABLE_CELLS_PER_DIJKSTRA_STEP = 4;
+
+    // Строка вершины лежит в блоке её компоненты, столбцы — номера вершин внутри компоненты
+    size_t GetRowOffset(VertexId vertex) const {
+        const uint32_t component = component_by_vertex_[vertex];
+        return component_offsets_[component] + index_in_component_[vertex] * component_sizes_[component];
+    }
+
+    void InitializeComponents(const uint32_t* component_by_vertex) {
+        component_by_vertex_.assign(component_by_vertex, component_by_vertex + vertex_count_);
+        index_in_component_.resize(vertex_count_);
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            const uint32_t component = component_by_vertex_[vertex];
+            if (component >= vertex_count_) {
+                throw std::out_of_range("Component id is out of range");
+            }
+            if (component >= component_sizes_.size()) {
+                component_sizes_.resize(component + 1, 0);
+            }
+            index_in_component_[vertex] = component_sizes_[component]++;
+        }
+        component_offsets_.assign(component_sizes_.size() + 1, 0);
+        component_vertices_offsets_.assign(component_sizes_.size() + 1, 0);
+        for (size_t component = 0; component < component_sizes_.size(); ++component) {
+            component_offsets_[component + 1] = component_offsets_[component]
+                                                + size_t{component_sizes_[component]} * component_sizes_[component];
+            component_vertices_offsets_[component + 1] = component_vertices_offsets_[component]
+                                                         + component_sizes_[component];
+        }
+        // Вершина каждой строки: номера внутри компоненты раздавались по возрастанию вершин
+        component_vertices_.resize(vertex_count_);
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            component_vertices_[component_vertices_offsets_[component_by_vertex_[vertex]] + index_in_component_[vertex]] = vertex;
+        }
+    }
 
     void InitializeRoutesInternalData(const Graph& graph) {
         const size_t vertex_count = graph.GetVertexCount();
+        if (graph.GetEdgeCount() > MAX_EDGE_COUNT) {
+            throw std::length_error("Too many edges for the all-pairs routes table");
+        }
         for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-            routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
-            for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
-                const auto& edge = graph.GetEdge(edge_id);
-                if (edge.weight < ZERO_WEIGHT) {
+            Weight* weights_from = weights_storage_.data() + GetRowOffset(vertex);
+            EdgeIndex* prev_edges_from = prev_edges_storage_.data() + GetRowOffset(vertex);
+            weights_from[index_in_component_[vertex]] = ZERO_WEIGHT;
+            graph.ForEachIncidentEdge(vertex, [&](EdgeId edge_id, VertexId to, Weight weight) {
+                if (weight < ZERO_WEIGHT) {
                     throw std::domain_error("Edges' weights should be non-negative");
                 }
-                auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                    route_internal_data = RouteInternalData{edge.weight, edge_id};
+                const uint32_t index_to = index_in_component_[to];
+                if (weights_from[index_to] > weight) {
+                    weights_from[index_to] = weight;
+                    prev_edges_from[index_to] = static_cast<EdgeIndex>(edge_id);
                 }
-            }
+            });
         }
     }
 
-    void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-                    const RouteInternalData& route_to) {
-        auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-        const Weight candidate_weight = route_from.weight + route_to.weight;
-        if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-            route_relaxing = {candidate_weight,
-                              route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge};
+    void RelaxRoutesInternalDataThroughVertex(size_t row_begin, size_t row_end, VertexId vertex_through) {
+        const uint32_t component = component_by_vertex_[vertex_through];
+        const size_t size = component_sizes_[component];
+        const size_t block_offset = component_offsets_[component];
+        const size_t index_through = index_in_component_[vertex_through];
+        const Weight* weights_through = weights_storage_.data() + block_offset + index_through * size;
+        const EdgeIndex* prev_edges_through = prev_edges_storage_.data() + block_offset + index_through * size;
+        for (size_t row = row_begin; row < row_end; ++row) {
+            Weight* weights_from = weights_storage_.data() + block_offset + row * size;
+            EdgeIndex* prev_edges_from = prev_edges_storage_.data() + block_offset + row * size;
+            const Weight weight_from_through = weights_from[index_through];
+            if (row == index_through || weight_from_through == UNREACHABLE_WEIGHT) {
+                continue;
+            }
+            // Ребро в prev_edges_through отсутствует только для vertex_to == vertex_through,
+            // а через саму себя вершина vertex_through путь не улучшает
+            if constexpr ((std::is_same_v<Weight, double> || std::is_same_v<Weight, int32_t>)
+                          && std::is_same_v<EdgeIndex, uint32_t>) {
+                RelaxRowMinPlus(weight_from_through, weights_through, prev_edges_through,
+                                weights_from, prev_edges_from, size);
+            } else {
+                for (size_t column = 0; column < size; ++column) {
+                    const Weight candidate_weight = weight_from_through + weights_through[column];
+                    if (candidate_weight < weights_from[column]) {
+                        weights_from[column] = candidate_weight;
+                        prev_edges_from[column] = prev_edges_through[column];
+                    }
+                }
+            }
         }
     }
 
-    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-            if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                    if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                        RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
+    // Итерация vertex_through не меняет ни строку, ни столбец vertex_through,
+    // поэтому строки можно релаксировать независимо, синхронизируясь между итерациями.
+    // Компоненты независимы: большие делятся между потоками по строкам, малые
+    // достаются потокам целиком
+    void RelaxRoutesInternalDataThroughVertices(const std::vector<VertexId>& vertices_through) {
+        std::vector<std::vector<VertexId>> vertices_through_by_component(component_sizes_.size());
+        for (const VertexId vertex_through : vertices_through) {
+            vertices_through_by_component[component_by_vertex_[vertex_through]].push_back(vertex_through);
+        }
+        const size_t threads_count = std::clamp<size_t>(threads_count_, 1, std::max<size_t>(vertex_count_, 1));
+        parallel::Barrier barrier(threads_count);
+        parallel::RunInThreads(threads_count, [&](size_t thread_index) {
+            for (size_t component = 0; component < component_sizes_.size(); ++component) {
+                const size_t size = component_sizes_[component];
+                if (threads_count == 1 || size < threads_count * MIN_SHARED_ROWS_PER_THREAD) {
+                    if (component % threads_count == thread_index) {
+                        for (const VertexId vertex_through : vertices_through_by_component[component]) {
+                            RelaxRoutesInternalDataThroughVertex(0, size, vertex_through);
+                        }
                     }
+                    continue;
+                }
+                const size_t row_begin = size * thread_index / threads_count;
+                const size_t row_end = size * (thread_index + 1) / threads_count;
+                for (const VertexId vertex_through : vertices_through_by_component[component]) {
+                    RelaxRoutesInternalDataThroughVertex(row_begin, row_end, vertex_through);
+                    barrier.ArriveAndWait();
                 }
             }
+        });
+    }
+
+    void RecomputeRoutesInternalDataFrom(VertexId vertex_from) {
+        using QueueItem = std::pair<Weight, VertexId>;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+        const size_t size = component_sizes_[component_by_vertex_[vertex_from]];
+        Weight* weights_from = weights_storage_.data() + GetRowOffset(vertex_from);
+        EdgeIndex* prev_edges_from = prev_edges_storage_.data() + GetRowOffset(vertex_from);
+        std::fill(weights_from, weights_from + size, UNREACHABLE_WEIGHT);
+        std::fill(prev_edges_from, prev_edges_from + size, NO_EDGE);
+        weights_from[index_in_component_[vertex_from]] = ZERO_WEIGHT;
+        queue.push({ZERO_WEIGHT, vertex_from});
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weights_from[index_in_component_[vertex]] < weight) {
+                continue;
+            }
+            graph_.ForEachIncidentEdge(vertex, [&, weight = weight](EdgeId edge_id, VertexId to, Weight edge_weight) {
+                const Weight candidate_weight = weight + edge_weight;
+                const uint32_t index_to = index_in_component_[to];
+                if (candidate_weight < weights_from[index_to]) {
+                    weights_from[index_to] = candidate_weight;
+                    prev_edges_from[index_to] = static_cast<EdgeIndex>(edge_id);
+                    queue.push({candidate_weight, to});
+                }
+            });
         }
     }
 
-    static constexpr Weight ZERO_WEIGHT{};
     const Graph& graph_;
-    RoutesInternalData routes_internal_data_;
+    const size_t vertex_count_;
+    const size_t threads_count_;
+    std::vector<uint32_t> component_by_vertex_;
+    std::vector<uint32_t> index_in_component_;
+    std::vector<uint32_t> component_sizes_;
+    std::vector<size_t> component_offsets_;
+    std::vector<VertexId> component_vertices_;
+    std::vector<uint32_t> component_vertices_offsets_;
+    std::vector<Weight> weights_storage_;
+    std::vector<EdgeIndex> prev_edges_storage_;
+    const Weight* weights_ = nullptr;
+    const EdgeIndex* prev_edges_ = nullptr;
 };
 
-template <typename Weight>
-Router<Weight>::Router(const Graph& graph)
+template <typename Weight, typename Index>
+Router<Weight, Index>::Router(const Graph& graph, size_t threads_count)
     : graph_(graph)
-    , routes_internal_data_(graph.GetVertexCount(),
-                            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+    , vertex_count_(graph.GetVertexCount())
+    , threads_count_(threads_count)
 {
+    InitializeComponents(FindComponents(graph).component_by_vertex.data());
+    weights_storage_.assign(GetTableSize(), UNREACHABLE_WEIGHT);
+    prev_edges_storage_.assign(GetTableSize(), NO_EDGE);
+    weights_ = weights_storage_.data();
+    prev_edges_ = prev_edges_storage_.data();
     InitializeRoutesInternalData(graph);
 
-    const size_t vertex_count = graph.GetVertexCount();
-    for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+    std::vector<VertexId> vertices_through(vertex_count_);
+    std::iota(vertices_through.begin(), vertices_through.end(), 0);
+    RelaxRoutesInternalDataThroughVertices(vertices_through);
+}
+
+template <typename Weight, typename Index>
+Router<Weight, Index>::Router(const Graph& graph, const uint32_t* component_by_vertex, const Weight* weights,
+                              const EdgeIndex* prev_edges, size_t threads_count)
+    : graph_(graph)
+    , vertex_count_(graph.GetVertexCount())
+    , threads_count_(threads_count)
+    , weights_(weights)
+    , prev_edges_(prev_edges)
+{
+    if (graph.GetEdgeCount() > MAX_EDGE_COUNT) {
+        throw std::length_error("Too many edges for the all-pairs routes table");
     }
+    InitializeComponents(component_by_vertex);
 }
 
-template <typename Weight>
-std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
-                                                                             VertexId to) const {
-    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-    if (!route_internal_data) {
+template <typename Weight, typename Index>
+bool Router<Weight, Index>::UpdateEdges(const std::vector<EdgeId>& added_edges, const std::vector<EdgeId>& removed_edges) {
+    if (graph_.GetVertexCount() != vertex_count_ || graph_.GetEdgeCount() > MAX_EDGE_COUNT) {
+        return false;
+    }
+    for (const EdgeId edge_id : added_edges) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        if (component_by_vertex_[edge.from] != component_by_vertex_[edge.to]) {
+            return false;
+        }
+    }
+    // Удалённые рёбра могут разбить компоненту, но прежнее, более крупное разбиение остаётся верным
+    const size_t table_size = GetTableSize();
+    if (weights_storage_.empty() && table_size > 0) {
+        weights_storage_.assign(weights_, weights_ + table_size);
+        prev_edges_storage_.assign(prev_edges_, prev_edges_ + table_size);
+        weights_ = weights_storage_.data();
+        prev_edges_ = prev_edges_storage_.data();
+    }
+
+    if (!removed_edges.empty()) {
+        // Путь через ребро идёт в его конец последним этим ребром, поэтому строки с удалённым
+        // ребром находятся по одному столбцу конца ребра в блоке его компоненты
+        std::vector<VertexId> affected_vertices_from;
+        for (const EdgeId edge_id : removed_edges) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const uint32_t component = component_by_vertex_[edge.to];
+            if (component != component_by_vertex_[edge.from]) {
+                continue;
+            }
+            const size_t size = component_sizes_[component];
+            const EdgeIndex* prev_edges_to = prev_edges_storage_.data() + component_offsets_[component]
+                                             + index_in_component_[edge.to];
+            const VertexId* vertices = component_vertices_.data() + component_vertices_offsets_[component];
+            for (size_t row = 0; row < size; ++row) {
+                if (prev_edges_to[row * size] == edge_id) {
+                    affected_vertices_from.push_back(vertices[row]);
+                }
+            }
+        }
+        std::sort(affected_vertices_from.begin(), affected_vertices_from.end());
+        affected_vertices_from.erase(std::unique(affected_vertices_from.begin(), affected_vertices_from.end()),
+                                     affected_vertices_from.end());
+        const double dijkstra_cost = TABLE_CELLS_PER_DIJKSTRA_STEP * static_cast<double>(affected_vertices_from.size())
+                                     * (graph_.GetEdgeCount() + vertex_count_) * std::log2(vertex_count_ + 1);
+        double floyd_warshall_cost = 0;
+        for (const uint32_t size : component_sizes_) {
+            floyd_warshall_cost += static_cast<double>(size) * size * size;
+        }
+        if (dijkstra_cost > floyd_warshall_cost) {
+            return false;
+        }
+        const size_t threads_count = std::clamp<size_t>(threads_count_, 1, std::max<size_t>(affected_vertices_from.size(), 1));
+        parallel::RunInThreads(threads_count, [&](size_t thread_index) {
+            for (size_t i = thread_index; i < affected_vertices_from.size(); i += threads_count) {
+                RecomputeRoutesInternalDataFrom(affected_vertices_from[i]);
+            }
+        });
+    }
+
+    // Новый кратчайший путь состоит из старых путей, соединённых новыми рёбрами,
+    // поэтому достаточно итераций Флойда–Уоршелла через концы новых рёбер.
+    // Концы берутся всегда: пересчитанная строка уже учитывает ребро, а остальные ещё нет
+    std::vector<VertexId> vertices_through;
+    for (const EdgeId edge_id : added_edges) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        const size_t index = GetRowOffset(edge.from) + index_in_component_[edge.to];
+        if (edge.weight < weights_storage_[index]) {
+            weights_storage_[index] = edge.weight;
+            prev_edges_storage_[index] = static_cast<EdgeIndex>(edge_id);
+        }
+        vertices_through.push_back(edge.from);
+        vertices_through.push_back(edge.to);
+    }
+    std::sort(vertices_through.begin(), vertices_through.end());
+    vertices_through.erase(std::unique(vertices_through.begin(), vertices_through.end()), vertices_through.end());
+    RelaxRoutesInternalDataThroughVertices(vertices_through);
+    return true;
+}
+
+template <typename Weight, typename Index>
+std::optional<Weight> Router<Weight, Index>::BuildRoute(VertexId from, VertexId to, std::vector<EdgeId>& edges) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    edges.clear();
+    if (component_by_vertex_[from] != component_by_vertex_[to]) {
         return std::nullopt;
     }
-    const Weight weight = route_internal_data->weight;
-    std::vector<EdgeId> edges;
-    for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-         edge_id;
-         edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+    const size_t row_offset = GetRowOffset(from);
+    const Weight weight = weights_[row_offset + index_in_component_[to]];
+    if (weight == UNREACHABLE_WEIGHT) {
+        return std::nullopt;
+    }
+    for (EdgeIndex edge_id = prev_edges_[row_offset + index_in_component_[to]];
+         edge_id != NO_EDGE;
+         edge_id = prev_edges_[row_offset + index_in_component_[graph_.GetEdge(edge_id).from]])
     {
-        edges.push_back(*edge_id);
+        edges.push_back(edge_id);
     }
     std::reverse(edges.begin(), edges.end());
 
-    return RouteInfo{weight, std::move(edges)};
+    return weight;
+}
+
+template <typename Weight, typename Index>
+WeightsMatrix<Weight> Router<Weight, Index>::BuildWeightsMatrix(const std::vector<VertexId>& sources,
+                                                                const std::vector<VertexId>& targets) const {
+    const size_t vertex_count = vertex_count_;
+    const auto is_out_of_range = [vertex_count](VertexId vertex) {
+        return vertex >= vertex_count;
+    };
+    if (std::any_of(sources.begin(), sources.end(), is_out_of_range)
+        || std::any_of(targets.begin(), targets.end(), is_out_of_range)) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    WeightsMatrix<Weight> matrix(sources.size(), std::vector<std::optional<Weight>>(targets.size()));
+    for (size_t source_index = 0; source_index < sources.size(); ++source_index) {
+        const VertexId source = sources[source_index];
+        const Weight* weights_from = weights_ + GetRowOffset(source);
+        for (size_t target_index = 0; target_index < targets.size(); ++target_index) {
+            const VertexId target = targets[target_index];
+            if (component_by_vertex_[source] == component_by_vertex_[target]
+                && weights_from[index_in_component_[target]] != UNREACHABLE_WEIGHT) {
+                matrix[source_index][target_index] = weights_from[index_in_component_[target]];
+            }
+        }
+    }
+    return matrix;
+}
+
+template <typename Weight, typename Index>
+const std::vector<uint32_t>& Router<Weight, Index>::GetComponentByVertex() const {
+    return component_by_vertex_;
+}
+
+template <typename Weight, typename Index>
+size_t Router<Weight, Index>::GetTableSize() const {
+    return component_offsets_.back();
+}
+
+template <typename Weight, typename Index>
+const Weight* Router<Weight, Index>::GetWeights() const {
+    return weights_;
+}
+
+template <typename Weight, typename Index>
+const typename Router<Weight, Index>::EdgeIndex* Router<Weight, Index>::GetPrevEdges() const {
+    return prev_edges_;
+}
+
+template <typename Weight, typename Index>
+size_t Router<Weight, Index>::ComputeTableSize(const uint32_t* component_by_vertex, size_t vertex_count) {
+    std::vector<size_t> component_sizes(vertex_count, 0);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        if (component_by_vertex[vertex] >= vertex_count) {
+            throw std::out_of_range("Component id is out of range");
+        }
+        ++component_sizes[component_by_vertex[vertex]];
+    }
+    size_t table_size = 0;
+    for (const size_t component_size : component_sizes) {
+        table_size += component_size * component_size;
+    }
+    return table_size;
 }
 
 }  // namespace graph
@@ -0,0 +1,85 @@
+#include "string_interner.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+namespace transport {
+
+NameId StringInterner::Intern(std::string_view name) {
+    if ((names_.size() + 1) * 2 > slots_.size()) {
+        Rehash(std::max(MIN_SLOT_COUNT, slots_.size() * 2));
+    }
+    const size_t hash = std::hash<std::string_view>{}(name);
+    const size_t slot = FindSlot(name, hash);
+    if (slots_[slot] != NO_NAME) {
+        return slots_[slot];
+    }
+    if (names_.size() >= NO_NAME) {
+        throw std::length_error("Too many names");
+    }
+    const NameId name_id = names_.size();
+    names_.push_back(Store(name));
+    hashes_.push_back(hash);
+    slots_[slot] = name_id;
+    return name_id;
+}
+
+NameId StringInterner::Find(std::string_view name) const {
+    if (slots_.empty()) {
+        return NO_NAME;
+    }
+    return slots_[FindSlot(name, std::hash<std::string_view>{}(name))];
+}
+
+std::string_view StringInterner::GetName(NameId name_id) const {
+    return names_.at(name_id);
+}
+
+size_t StringInterner::GetNameCount() const {
+    return names_.size();
+}
+
+size_t StringInterner::GetMemoryUsage() const {
+    return allocated_size_ + blocks_.capacity() * sizeof(std::unique_ptr<char[]>) 
+           + names_.capacity() * sizeof(std::string_view) + hashes_.capacity() * sizeof(size_t) 
+           + slots_.capacity() * sizeof(NameId);
+}
+
+// Слот с этим именем или первый пустой; таблица заполнена не больше чем наполовину
+size_t StringInterner::FindSlot(std::string_view name, size_t hash) const {
+    const size_t mask = slots_.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        const NameId name_id = slots_[slot];
+        if (name_id == NO_NAME || (hashes_[name_id] == hash && names_[name_id] == name)) {
+            return slot;
+        }
+    }
+}
+
+std::string_view StringInterner::Store(std::string_view name) {
+    if (blocks_.empty() || block_used_ + name.size() > block_capacity_) {
+        block_capacity_ = std::max(BLOCK_SIZE, name.size());
+        blocks_.push_back(std::make_unique<char[]>(block_capacity_));
+        allocated_size_ += block_capacity_;
+        block_used_ = 0;
+    }
+    char* data = blocks_.back().get() + block_used_;
+    std::copy(name.begin(), name.end(), data);
+    block_used_ += name.size();
+    return {data, name.size()};
+}
+
+void StringInterner::Rehash(size_t slot_count) {
+    slots_.assign(slot_count, NO_NAME);
+    const size_t mask = slot_count - 1;
+    for (NameId name_id = 0; name_id < names_.size(); ++name_id) {
+        size_t slot = hashes_[name_id] & mask;
+        while (slots_[slot] != NO_NAME) {
+            slot = (slot + 1) & mask;
+        }
+        slots_[slot] = name_id;
+    }
+}
+
+} // namespace transport
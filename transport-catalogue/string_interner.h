@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace transport {
+
+using NameId = uint32_t;
+
+// Хранилище имён: каждое имя лежит один раз в общем буфере из блоков, которые не
+// перемещаются, поэтому string_view на имя действует, пока жив интернатор.
+// Поиск имени — открытая адресация с линейным пробированием по таблице номеров
+class StringInterner {
+public:
+    static constexpr NameId NO_NAME = std::numeric_limits<NameId>::max();
+
+    // Номер имени; новое имя копируется в буфер
+    NameId Intern(std::string_view name);
+    // NO_NAME — такого имени нет
+    NameId Find(std::string_view name) const;
+    std::string_view GetName(NameId name_id) const;
+    size_t GetNameCount() const;
+    size_t GetMemoryUsage() const;
+
+private:
+    static constexpr size_t BLOCK_SIZE = size_t{1} << 16;
+    static constexpr size_t MIN_SLOT_COUNT = 16;
+
+    size_t FindSlot(std::string_view name, size_t hash) const;
+    std::string_view Store(std::string_view name);
+    void Rehash(size_t slot_count);
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    size_t block_used_ = 0;
+    size_t block_capacity_ = 0;
+    size_t allocated_size_ = 0;
+    std::vector<std::string_view> names_;
+    std::vector<size_t> hashes_;
+    std::vector<NameId> slots_;
+};
+
+} // namespace transport
@@ -1,68 +1,166 @@
 #include "transport_catalogue.h"
 
 #include <algorithm>
+#include <stdexcept>
 
 namespace transport {
 
-void TransportCatalogue::AddStop(const std::string& stop_name, const geo::Coordinates& stop_coordinates) {
-    stops_.push_back({stop_name, stop_coordinates});
+void TransportCatalogue::AddStop(std::string_view stop_name, const geo::Coordinates& stop_coordinates) {
+    const NameId name_id = InternName(stop_name);
+    const StopId stop_id = stops_.size();
+    stops_.push_back({names_.GetName(name_id), stop_coordinates, stop_id});
+    stop_id_by_name_id_[name_id] = stop_id;
     stop_info_by_stop_name_[stops_.back().name] = &stops_.back();
-    routes_through_stop_by_stop_name_[stops_.back().name];
+    routes_through_stop_by_stop_id_.emplace_back();
 }
 
 void TransportCatalogue::AddDistance(std::string_view stop_from, std::string_view stop_to, int distance) {
-    distances_between_stops_[{GetStop(stop_from), GetStop(stop_to)}] = distance;
-    if (!distances_between_stops_.count({GetStop(stop_to), GetStop(stop_from)})) {
-        distances_between_stops_[{GetStop(stop_to), GetStop(stop_from)}] = distance;
+    const StopId stop_from_id = GetStopId(stop_from);
+    const StopId stop_to_id = GetStopId(stop_to);
+    // Без перестройки хранилища: новая пара попадает в хеш-таблицу до следующего AddDistances
+    road_distances_.Insert(stop_from_id, stop_to_id, distance);
+    if (!road_distances_.Find(stop_to_id, stop_from_id)) {
+        road_distances_.Insert(stop_to_id, stop_from_id, distance);
+    }
+    // Пара остановок встречается только в маршрутах, проходящих через обе
+    for (const std::string_view route_name : routes_through_stop_by_stop_id_[stop_from_id]) {
+        route_info_by_route_id_[GetRoute(route_name)->id].reset();
     }
 }
+
+void TransportCatalogue::AddDistances(const std::vector<RoadDistance>& distances) {
+    std::vector<RoadDistances::Entry> new_entries;
+    new_entries.reserve(distances.size());
+    for (const RoadDistance& road_distance : distances) {
+        new_entries.push_back({GetStopId(road_distance.stop_from), GetStopId(road_distance.stop_to), road_distance.distance});
+    }
+    // Из записей одной пары хранилище оставляет последнюю, поэтому порядок такой: обратные
+    // направления от поздних к ранним, затем уже известные расстояния, затем новые прямые
+    std::vector<RoadDistances::Entry> entries;
+    entries.reserve(new_entries.size() * 2 + road_distances_.GetEntryCount());
+    for (auto it = new_entries.rbegin(); it != new_entries.rend(); ++it) {
+        entries.push_back({it->stop_to, it->stop_from, it->distance});
+    }
+    for (const RoadDistances::Entry& entry : road_distances_.GetEntries()) {
+        entries.push_back(entry);
+    }
+    entries.insert(entries.end(), new_entries.begin(), new_entries.end());
+    road_distances_ = RoadDistances(stops_.size(), std::move(entries));
+    std::fill(route_info_by_route_id_.begin(), route_info_by_route_id_.end(), std::nullopt);
+}
     
-void TransportCatalogue::AddRoute(const std::string& route_name, const std::vector<std::string>& route_stops, bool is_roundtrip) {
-    routes_.push_back({route_name, route_stops, is_roundtrip});
-    route_info_by_route_name_[routes_.back().name] = &routes_.back();
+void TransportCatalogue::AddRoute(std::string_view route_name, const std::vector<std::string>& route_stops, bool is_roundtrip) {
+    RemoveRoute(route_name);
+    std::vector<StopId> stop_ids;
+    stop_ids.reserve(route_stops.size());
     for (const std::string& stop_name : route_stops) {
-        routes_through_stop_by_stop_name_.at(stop_name).insert(routes_.back().name);
+        stop_ids.push_back(GetStopId(stop_name));
+    }
+    const NameId name_id = InternName(route_name);
+    const RouteId route_id = routes_.size();
+    routes_.push_back({names_.GetName(name_id), std::move(stop_ids), is_roundtrip, route_id});
+    route_by_name_id_[name_id] = &routes_.back();
+    route_info_by_route_name_[routes_.back().name] = &routes_.back();
+    route_info_by_route_id_.emplace_back();
+    for (const StopId stop_id : routes_.back().stops) {
+        routes_through_stop_by_stop_id_[stop_id].insert(routes_.back().name);
+    }
+}
+
+void TransportCatalogue::RemoveRoute(std::string_view route_name) {
+    const Route* route = GetRoute(route_name);
+    if (!route) {
+        return;
+    }
+    for (const StopId stop_id : route->stops) {
+        routes_through_stop_by_stop_id_[stop_id].erase(route->name);
     }
+    // Сам маршрут остаётся в routes_, чтобы ссылки на него и его номер оставались валидными
+    route_by_name_id_[names_.Find(route->name)] = nullptr;
+    route_info_by_route_name_.erase(route->name);
 }
 
 const Stop* TransportCatalogue::GetStop(std::string_view stop_name) const {
-    if (!stop_info_by_stop_name_.count(stop_name)) {
+    const NameId name_id = names_.Find(stop_name);
+    if (name_id == StringInterner::NO_NAME || stop_id_by_name_id_[name_id] == NO_STOP) {
         return nullptr;
     }
-    return stop_info_by_stop_name_.at(stop_name);
+    return &stops_[stop_id_by_name_id_[name_id]];
 }
 
 const Route* TransportCatalogue::GetRoute(std::string_view route_name) const {
-    if (!route_info_by_route_name_.count(route_name)) {
-        return nullptr;
-    }
-    return route_info_by_route_name_.at(route_name);
+    const NameId name_id = names_.Find(route_name);
+    return name_id == StringInterner::NO_NAME ? nullptr : route_by_name_id_[name_id];
 }
     
 int TransportCatalogue::GetDistance(std::string_view stop_from, std::string_view stop_to) const {
-    return distances_between_stops_.at({GetStop(stop_from), GetStop(stop_to)});
+    return GetDistance(GetStopId(stop_from), GetStopId(stop_to));
 }    
 
+const Stop& TransportCatalogue::GetStop(StopId stop_id) const {
+    return stops_.at(stop_id);
+}
+
+const Route& TransportCatalogue::GetRoute(RouteId route_id) const {
+    return routes_.at(route_id);
+}
+
+int TransportCatalogue::GetDistance(StopId stop_from, StopId stop_to) const {
+    const int* distance = road_distances_.Find(stop_from, stop_to);
+    if (!distance) {
+        throw std::out_of_range("Road distance is unknown");
+    }
+    return *distance;
+}
+
+size_t TransportCatalogue::GetStopCount() const {
+    return stops_.size();
+}
+
+const RoadDistances& TransportCatalogue::GetRoadDistances() const {
+    return road_distances_;
+}
+
+const StringInterner& TransportCatalogue::GetNames() const {
+    return names_;
+}
+
+StopId TransportCatalogue::GetStopId(std::string_view stop_name) const {
+    const Stop* stop = GetStop(stop_name);
+    if (!stop) {
+        throw std::out_of_range("Unknown stop");
+    }
+    return stop->id;
+}
+
+// Имена остановок и маршрутов общие, поэтому обе таблицы растут вместе с интернатором
+NameId TransportCatalogue::InternName(std::string_view name) {
+    const NameId name_id = names_.Intern(name);
+    if (name_id == stop_id_by_name_id_.size()) {
+        stop_id_by_name_id_.push_back(NO_STOP);
+        route_by_name_id_.push_back(nullptr);
+    }
+    return name_id;
+}
+
 TransportCatalogue::RouteInfo TransportCatalogue::GetRouteInfo(std::string_view route_name) const {
-    if (!route_info_by_route_name_.count(route_name)) {
+    const Route* route = GetRoute(route_name);
+    if (!route) {
         return {0, 0, 0, 0.0};
     }
-    Route route = *GetRoute(route_name);
-    int stop_count = route.stops.size();
-    if (!route.is_roundtrip) {
-        stop_count = (stop_count * 2) - 1;
+    std::optional<RouteInfo>& route_info = route_info_by_route_id_[route->id];
+    if (!route_info) {
+        route_info = CalculateRouteInfo(*route);
     }
-    int unique_stop_count = std::unordered_set(route.stops.begin(), route.stops.end()).size();
-    int real_route_length = CalculateRealRouteLength(*route_info_by_route_name_.at(route_name));
-    double geo_route_length = CalculateGeoRouteLength(*route_info_by_route_name_.at(route_name));
-    return {stop_count, unique_stop_count, real_route_length, real_route_length / geo_route_length};
+    return *route_info;
 }
 
 const std::unordered_set<std::string_view>* TransportCatalogue::GetRoutesThroughStop(std::string_view stop_name) const {
-    if (!routes_through_stop_by_stop_name_.count(stop_name)) {
+    const Stop* stop = GetStop(stop_name);
+    if (!stop) {
         return nullptr;
     }
-    return &routes_through_stop_by_stop_name_.at(stop_name);
+    return &routes_through_stop_by_stop_id_[stop->id];
 }
     
 const std::unordered_map<std::string_view, const Route*>& TransportCatalogue::GetAllRoutes() const {  
@@ -86,11 +184,22 @@ int TransportCatalogue::CalculateRealRouteLength(const Route& route) const {
     return route_length;
 }
     
+TransportCatalogue::RouteInfo TransportCatalogue::CalculateRouteInfo(const Route& route) const {
+    int stop_count = route.stops.size();
+    if (!route.is_roundtrip) {
+        stop_count = (stop_count * 2) - 1;
+    }
+    int unique_stop_count = std::unordered_set(route.stops.begin(), route.stops.end()).size();
+    int real_route_length = CalculateRealRouteLength(route);
+    double geo_route_length = CalculateGeoRouteLength(route);
+    return {stop_count, unique_stop_count, real_route_length, real_route_length / geo_route_length};
+}
+    
 double TransportCatalogue::CalculateGeoRouteLength(const Route& route) const {
     std::vector<geo::Coordinates> stops_coords;
     stops_coords.reserve(route.stops.size());   
-    for (const std::string& stop_name : route.stops) {
-        stops_coords.push_back(GetStop(stop_name)->coordinates);
+    for (const StopId stop_id : route.stops) {
+        stops_coords.push_back(stops_[stop_id].coordinates);
     } 
     double route_length = 0.0;
     for (size_t i = 0; i < stops_coords.size() - 1; ++i) {
@@ -102,9 +211,4 @@ double TransportCatalogue::CalculateGeoRouteLength(const Route& route) const {
     return route_length;
 }
     
-size_t TransportCatalogue::NearbyStopsHasher::operator()(std::pair<const Stop*, const Stop*> nearby_stops) const {
-    return static_cast<size_t>(37*std::hash<const void*>()(nearby_stops.first) + 
-                                  std::hash<const void*>()(nearby_stops.second));
-}    
-    
 } // namespace transport
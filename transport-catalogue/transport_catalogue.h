@@ -2,8 +2,12 @@
 
 #include "domain.h"
 #include "geo.h"
+#include "road_distances.h"
+#include "string_interner.h"
 
 #include <deque>
+#include <limits>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -13,12 +17,30 @@ namespace transport {
     
 class TransportCatalogue {
 public: 
-    void AddStop(const std::string& stop_name, const geo::Coordinates& stop_coorditanes);
+    void AddStop(std::string_view stop_name, const geo::Coordinates& stop_coorditanes);
+    struct RoadDistance {
+        std::string_view stop_from;
+        std::string_view stop_to;
+        int distance;
+    };
+
+    // Обратное направление получает то же расстояние, если оно ещё не задано
     void AddDistance(std::string_view stop_from, std::string_view stop_to, int distance);
-    void AddRoute(const std::string& route_name, const std::vector<std::string>& route_stops, bool is_roundtrip);  
+    // То же для многих расстояний с одной перестройкой хранилища
+    void AddDistances(const std::vector<RoadDistance>& distances);
+    // Маршрут с тем же именем заменяется: прежний удаляется как в RemoveRoute, а новый получает
+    // новый RouteId. Маршрутизатор об изменении не знает, пока не вызван TransportRouter::UpdateRoute
+    void AddRoute(std::string_view route_name, const std::vector<std::string>& route_stops, bool is_roundtrip);  
+    void RemoveRoute(std::string_view route_name);
     const Stop* GetStop(std::string_view stop_name) const;
     const Route* GetRoute(std::string_view route_name) const;
     int GetDistance(std::string_view stop_from, std::string_view stop_to) const;
+    // Доступ по номерам без поиска по именам; номер удалённого маршрута остаётся занятым
+    const Stop& GetStop(StopId stop_id) const;
+    const Route& GetRoute(RouteId route_id) const;
+    int GetDistance(StopId stop_from, StopId stop_to) const;
+    size_t GetStopCount() const;
+    const RoadDistances& GetRoadDistances() const;
     
     struct RouteInfo {
         int number_of_stops;
@@ -27,27 +49,35 @@ public:
         double curvature;
     };
     
+    // Считается при первом запросе и запоминается до изменения маршрута или его расстояний
     RouteInfo GetRouteInfo(std::string_view route_name) const; 
     const std::unordered_set<std::string_view>* GetRoutesThroughStop(std::string_view stop_name) const;
     
     const std::unordered_map<std::string_view, const Route*>& GetAllRoutes() const;
     const std::unordered_map<std::string_view, const Stop*>& GetAllStops() const;
+    // Имена остановок и маршрутов, на которые ссылаются Stop::name и Route::name
+    const StringInterner& GetNames() const;
      
 private:
+    static constexpr StopId NO_STOP = std::numeric_limits<StopId>::max();
+
+    StopId GetStopId(std::string_view stop_name) const;
+    NameId InternName(std::string_view name);
+
     double CalculateGeoRouteLength(const Route& route) const;
     int CalculateRealRouteLength(const Route& route) const;
+    RouteInfo CalculateRouteInfo(const Route& route) const;
     
-    class NearbyStopsHasher {
-    public:
-        size_t operator()(std::pair<const Stop*, const Stop*> nearby_stops) const;
-    }; 
-    
+    StringInterner names_;
+    std::vector<StopId> stop_id_by_name_id_;
+    std::vector<const Route*> route_by_name_id_;
     std::deque<Stop> stops_;
     std::deque<Route> routes_;
     std::unordered_map<std::string_view, const Stop*> stop_info_by_stop_name_;
     std::unordered_map<std::string_view, const Route*> route_info_by_route_name_;
-    std::unordered_map<std::string_view, std::unordered_set<std::string_view>> routes_through_stop_by_stop_name_;
-    std::unordered_map<std::pair<const Stop*, const Stop*>, int, NearbyStopsHasher> distances_between_stops_;    
+    std::vector<std::unordered_set<std::string_view>> routes_through_stop_by_stop_id_;
+    RoadDistances road_distances_;
+    mutable std::vector<std::optional<RouteInfo>> route_info_by_route_id_;
 };
     
 } // namespace transport
@@ -1,43 +1,1102 @@
+#include "catalogue_snapshot.h"
 #include "transport_router.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
 
 namespace transport {
+
+namespace {
+
+// Секции снимка выровнены по 8 байт, числа хранятся в порядке байтов машины,
+// записавшей снимок; при смене раскладки нужно увеличивать SNAPSHOT_VERSION
+const char SNAPSHOT_MAGIC[8] = {'T', 'C', 'R', 'O', 'U', 'T', 'E', '\0'};
+const uint32_t SNAPSHOT_VERSION = 9;
+const size_t SNAPSHOT_ALIGNMENT = 8;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t router_type;
+    uint32_t graph_model;
+    int32_t bus_wait_time;
+    double bus_velocity;
+    double heuristic_scale;
+    double weight_units_per_minute;
+    uint64_t cached_trees_limit;
+    uint64_t threads_count;
+    uint64_t compact_parallel_edges;
+    uint64_t vertex_count;
+    uint64_t stop_count;
+    uint64_t bus_count;
+    uint64_t edge_count;
+    uint64_t names_size;
+    // 0 — таблицы всех пар в снимке нет, иначе размер номера ребра в ней
+    uint64_t routes_table_edge_index_size;
+    uint64_t raptor_route_count;
+    uint64_t raptor_route_stop_count;
+    uint64_t catalogue_fingerprint;
+};
+
+struct SnapshotName {
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct SnapshotEdgeRange {
+    uint64_t begin;
+    uint64_t end;
+};
+
+struct SnapshotEdge {
+    uint32_t from;
+    uint32_t to;
+    RouteWeight weight;
+};
+
+static_assert(std::is_trivially_copyable_v<geo::Coordinates>);
+
+// FNV-1a по данным каталога, от которых зависит маршрутизатор: остановкам с координатами и маршрутам
+// с расстояниями между соседними остановками. Всё перебирается по именам, поэтому порядок
+// добавления в каталог не важен
+uint64_t ComputeCatalogueFingerprint(const TransportCatalogue& ctlg) {
+    uint64_t fingerprint = 14695981039346656037ull;
+    const auto add_bytes = [&fingerprint](const void* data, size_t size) {
+        for (size_t index = 0; index < size; ++index) {
+            fingerprint = (fingerprint ^ static_cast<const unsigned char*>(data)[index]) * 1099511628211ull;
+        }
+    };
+    const auto add_value = [&add_bytes](auto value) {
+        add_bytes(&value, sizeof(value));
+    };
+    const auto add_name = [&add_bytes, &add_value](std::string_view name) {
+        add_value(uint64_t{name.size()});
+        add_bytes(name.data(), name.size());
+    };
+    const CatalogueSnapshot snapshot(ctlg);
+    add_value(uint64_t{snapshot.GetSortedStops().size()});
+    for (const Stop* stop : snapshot.GetSortedStops()) {
+        add_name(stop->name);
+        add_value(stop->coordinates.lat);
+        add_value(stop->coordinates.lng);
+    }
+    add_value(uint64_t{snapshot.GetSortedRoutes().size()});
+    for (const Route* route : snapshot.GetSortedRoutes()) {
+        add_name(route->name);
+        add_value(uint64_t{route->is_roundtrip});
+        add_value(uint64_t{route->stops.size()});
+        for (size_t index = 0; index < route->stops.size(); ++index) {
+            add_name(ctlg.GetStop(route->stops[index]).name);
+            if (index == 0) {
+                continue;
+            }
+            add_value(ctlg.GetDistance(route->stops[index - 1], route->stops[index]));
+            if (!route->is_roundtrip) {
+                add_value(ctlg.GetDistance(route->stops[index], route->stops[index - 1]));
+            }
+        }
+    }
+    return fingerprint;
+}
+
+template <typename T>
+void WriteSnapshotSection(std::ostream& out, const T* data, size_t count) {
+    const size_t size = sizeof(T) * count;
+    out.write(reinterpret_cast<const char*>(data), size);
+    const char padding[SNAPSHOT_ALIGNMENT] = {};
+    out.write(padding, (SNAPSHOT_ALIGNMENT - size % SNAPSHOT_ALIGNMENT) % SNAPSHOT_ALIGNMENT);
+}
+
+using AllPairsRouter = graph::Router<RouteWeight>;
+// Для графа, номера рёбер которого не помещаются в 32 бита
+using WideAllPairsRouter = graph::Router<RouteWeight, uint64_t>;
+
+template <typename Router>
+void WriteRoutesTable(std::ostream& out, const Router& router, size_t vertex_count) {
+    WriteSnapshotSection(out, router.GetComponentByVertex().data(), vertex_count);
+    WriteSnapshotSection(out, router.GetWeights(), router.GetTableSize());
+    WriteSnapshotSection(out, router.GetPrevEdges(), router.GetTableSize());
+}
+
+class SnapshotReader {
+public:
+    explicit SnapshotReader(const MappedFile& file)
+        : data_(file.GetData())
+        , size_(file.GetSize()) {
+    }
+    
+    template <typename T>
+    const T* ReadSection(size_t count) {
+        const size_t size = sizeof(T) * count;
+        if (count > size_ / sizeof(T) || size_ - offset_ < size) {
+            throw std::runtime_error("Routing snapshot is truncated");
+        }
+        const T* section = reinterpret_cast<const T*>(data_ + offset_);
+        offset_ += size + (SNAPSHOT_ALIGNMENT - size % SNAPSHOT_ALIGNMENT) % SNAPSHOT_ALIGNMENT;
+        offset_ = std::min(offset_, size_);
+        return section;
+    }
+    
+private:
+    const char* data_;
+    size_t size_;
+    size_t offset_ = 0;
+};
+
+// Соседние остановки маршрута в любом порядке: только их расстояния входят в веса его рёбер
+bool HasAdjacentStops(const Route& route, StopId lhs, StopId rhs) {
+    for (size_t index = 1; index < route.stops.size(); ++index) {
+        const StopId prev_stop = route.stops[index - 1];
+        const StopId stop = route.stops[index];
+        if ((prev_stop == lhs && stop == rhs) || (prev_stop == rhs && stop == lhs)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Наибольший вес, не превышающий minutes: в отличие от весов рёбер округляется вниз
+RouteWeight MinutesToRouteWeightBound(double minutes) {
+    if constexpr (std::is_integral_v<RouteWeight>) {
+        const double units = std::floor(minutes * ROUTE_WEIGHT_UNITS_PER_MINUTE);
+        return static_cast<RouteWeight>(std::min<double>(units, std::numeric_limits<RouteWeight>::max() / 2));
+    } else {
+        return minutes;
+    }
+}
+
+} // namespace
+
+RouteWeight MinutesToRouteWeight(double minutes) {
+    if constexpr (std::is_integral_v<RouteWeight>) {
+        const double units = std::ceil(minutes * ROUTE_WEIGHT_UNITS_PER_MINUTE);
+        // Половина диапазона оставлена под недостижимые пути и суммы весов
+        if (units > std::numeric_limits<RouteWeight>::max() / 2) {
+            throw std::overflow_error("Edge weight doesn't fit into fixed-point route weight");
+        }
+        return static_cast<RouteWeight>(units);
+    } else {
+        return minutes;
+    }
+}
+
+double RouteWeightToMinutes(RouteWeight weight) {
+    return weight / ROUTE_WEIGHT_UNITS_PER_MINUTE;
+}
     
 void TransportRouter::SetSettings(RoutingSettings routing_settings) {
     routing_settings_ = routing_settings;
 }
 
+const RoutingSettings& TransportRouter::GetSettings() const {
+    return routing_settings_;
+}
+
 void TransportRouter::UploadTransportData(const transport::TransportCatalogue& ctlg) {
-    graph_data_ = std::move(GraphAndItsTransportData<double>{graph::DirectedWeightedGraph<double>(ctlg.GetAllStops().size())});
+    const bool is_raptor = routing_settings_.router_type == RouterType::RAPTOR;
+    const size_t stop_count = ctlg.GetAllStops().size();
+    const size_t vertex_count = stop_count + (is_raptor ? 0 : CountRouteStopVertices(ctlg));
+    graph_data_ = std::move(GraphAndItsTransportData<RouteWeight>{graph::DirectedWeightedGraph<RouteWeight>(vertex_count)});
+    graph_data_.coordinates_by_vertex_id.resize(vertex_count);
+    next_route_stop_vertex_id_ = stop_count;
     AddVertexIdsInGraphData(ctlg.GetAllStops());
+    MapStopIdsToVertexIds(ctlg);
+    RaptorRoutes raptor_routes;
+    bus_id_by_raptor_route_.clear();
+    std::vector<const Route*> routes;
+    std::vector<graph::VertexId> first_route_stop_vertex_ids;
+    size_t edge_count = 0;
     for (const auto [route_name, route_ptr] : ctlg.GetAllRoutes()) {
-        const auto& vec_stops = route_ptr->stops;
-        if (route_ptr->is_roundtrip) {
-            AddRouteInGraph(ctlg, vec_stops.begin(), vec_stops.size(), route_name);
-        } else {
-            AddRouteInGraph(ctlg, vec_stops.begin(), vec_stops.size(), route_name);
-            AddRouteInGraph(ctlg, vec_stops.rbegin(), vec_stops.size(), route_name);            
+        const uint32_t bus_id = graph_data_.bus_name_by_id.size();
+        graph_data_.bus_name_by_id.push_back(route_name);
+        graph_data_.bus_id_by_name[route_name] = bus_id;
+        graph_data_.edge_range_by_bus_id.emplace_back();
+        if (is_raptor) {
+            AddRouteInRaptorRoutes(ctlg, *route_ptr, bus_id, raptor_routes);
+            continue;
+        }
+        routes.push_back(route_ptr);
+        first_route_stop_vertex_ids.push_back(next_route_stop_vertex_id_);
+        edge_count += CountRouteEdges(*route_ptr);
+        if (routing_settings_.graph_model == GraphModel::ROUTE_STOPS) {
+            next_route_stop_vertex_id_ += route_ptr->is_roundtrip ? route_ptr->stops.size() : route_ptr->stops.size() * 2;
         }
     }
-    router_ = std::make_unique<graph::Router<double>>(graph_data_.graph);
+    graph_data_.graph.ReserveEdges(edge_count);
+    EdgesTransportData& edges_data = graph_data_.edges_data;
+    for (auto* column : {&edges_data.bus_ids, &edges_data.span_counts, &edges_data.start_stop_ids, &edges_data.finish_stop_ids}) {
+        column->reserve(edge_count);
+    }
+    edges_data.types.reserve(edge_count);
+    // Рёбра автобусов строятся параллельно пачками не больше ROUTE_EDGES_BATCH_LIMIT рёбер,
+    // а в граф попадают по порядку номеров автобусов
+    std::vector<RouteEdges> route_edges(routes.size());
+    const size_t threads_count = std::max<size_t>(routing_settings_.threads_count, 1);
+    for (size_t batch_begin = 0; batch_begin < routes.size();) {
+        size_t batch_end = batch_begin;
+        for (size_t batch_edge_count = 0; batch_end < routes.size() && (batch_end == batch_begin 
+                                          || batch_edge_count + CountRouteEdges(*routes[batch_end]) <= ROUTE_EDGES_BATCH_LIMIT); ++batch_end) {
+            batch_edge_count += CountRouteEdges(*routes[batch_end]);
+        }
+        const size_t batch_threads_count = std::min(threads_count, batch_end - batch_begin);
+        parallel::RunInThreads(batch_threads_count, [&](size_t thread_index) {
+            for (size_t bus_id = batch_begin + thread_index; bus_id < batch_end; bus_id += batch_threads_count) {
+                BuildRouteEdges(ctlg, *routes[bus_id], bus_id, first_route_stop_vertex_ids[bus_id], route_edges[bus_id]);
+            }
+        });
+        for (size_t bus_id = batch_begin; bus_id < batch_end; ++bus_id) {
+            AddRouteEdgesInGraph(route_edges[bus_id], bus_id);
+            route_edges[bus_id] = {};
+        }
+        batch_begin = batch_end;
+    }
+    removed_parallel_edge_count_ = routing_settings_.compact_parallel_edges ? graph_data_.graph.RemoveParallelEdges() : 0;
+    graph_data_.graph.Freeze();
+    graph_data_.component_by_vertex_id = graph::FindComponents(graph_data_.graph).component_by_vertex;
+    heuristic_scale_ = ComputeHeuristicScale(ctlg);
+    dead_edge_count_ = 0;
+    dead_vertex_count_ = 0;
+    router_ = MakeRoutingEngine();
+    raptor_ = is_raptor ? std::make_unique<Raptor<RouteWeight>>(stop_count, std::move(raptor_routes), MakeRaptorLegWeight()) 
+                        : nullptr;
+    snapshot_.reset();
+}
+
+void TransportRouter::UpdateRoute(const transport::TransportCatalogue& ctlg, std::string_view route_name) {
+    UpdateRoutesAndDistances(ctlg, {route_name}, {});
+}
+
+void TransportRouter::UpdateDistance(const transport::TransportCatalogue& ctlg, std::string_view stop_from, 
+                                     std::string_view stop_to) {
+    UpdateRoutesAndDistances(ctlg, {}, {{stop_from, stop_to}});
+}
+
+void TransportRouter::UpdateDistances(const transport::TransportCatalogue& ctlg,
+                                      const std::vector<std::pair<std::string_view, std::string_view>>& stop_pairs) {
+    UpdateRoutesAndDistances(ctlg, {}, stop_pairs);
+}
+
+void TransportRouter::UpdateRoutesAndDistances(const transport::TransportCatalogue& ctlg,
+                                               const std::vector<std::string_view>& route_names,
+                                               const std::vector<std::pair<std::string_view, std::string_view>>& stop_pairs) {
+    if (!router_ && !raptor_) {
+        return;
+    }
+    std::vector<std::string_view> changed_route_names = route_names;
+    for (const auto& [stop_from, stop_to] : stop_pairs) {
+        const Stop* stop_from_info = ctlg.GetStop(stop_from);
+        const Stop* stop_to_info = ctlg.GetStop(stop_to);
+        if (!stop_from_info || !stop_to_info) {
+            continue;
+        }
+        for (const std::string_view route_name : *ctlg.GetRoutesThroughStop(stop_from)) {
+            if (HasAdjacentStops(*ctlg.GetRoute(route_name), stop_from_info->id, stop_to_info->id)) {
+                changed_route_names.push_back(route_name);
+            }
+        }
+    }
+    // Порядок имён задаёт порядок новых рёбер, поэтому он не зависит от хеш-таблиц каталога
+    std::sort(changed_route_names.begin(), changed_route_names.end());
+    changed_route_names.erase(std::unique(changed_route_names.begin(), changed_route_names.end()),
+                              changed_route_names.end());
+    if (!changed_route_names.empty()) {
+        UpdateRoutes(ctlg, changed_route_names);
+    }
 }
 
 std::optional<PathInfo> TransportRouter::BuildPath(std::string_view stop_from, std::string_view stop_to) const {
-    if (!router_) {
+    PathInfo path_info;
+    if (!BuildPath(stop_from, stop_to, path_info)) {
         return std::nullopt;
-    }        
-    const auto route_info = router_->BuildRoute(graph_data_.vertex_id_by_stop_name.at(stop_from), 
-                                                graph_data_.vertex_id_by_stop_name.at(stop_to));
-    if (!route_info) {
-        return std::nullopt;   
+    }
+    return path_info;
+}
+
+bool TransportRouter::BuildPath(std::string_view stop_from, std::string_view stop_to, PathInfo& path_info) const {
+    path_info.items.clear();
+    if (raptor_) {
+        thread_local std::vector<Raptor<RouteWeight>::Leg> legs;
+        const auto weight = raptor_->BuildJourney(graph_data_.vertex_id_by_stop_name.at(stop_from), 
+                                                  graph_data_.vertex_id_by_stop_name.at(stop_to), legs);
+        if (!weight) {
+            return false;
+        }
+        FillRaptorPathInfo(legs, *weight, path_info);
+        return true;
+    }
+    if (!router_) {
+        return false;
+    }
+    // Буфер рёбер свой у каждого потока и переживает вызовы, поэтому поток запросов память не выделяет
+    thread_local std::vector<graph::EdgeId> route_edges;
+    const graph::VertexId vertex_from = graph_data_.vertex_id_by_stop_name.at(stop_from);
+    const graph::VertexId vertex_to = graph_data_.vertex_id_by_stop_name.at(stop_to);
+    if (graph_data_.component_by_vertex_id[vertex_from] != graph_data_.component_by_vertex_id[vertex_to]) {
+        return false;
+    }
+    const auto route_weight = router_->BuildRoute(vertex_from, vertex_to, route_edges);
+    if (!route_weight) {
+        return false;
+    }
+    auto& items = path_info.items;
+    for (graph::EdgeId edge_id : route_edges) {
+        const EdgeInfo edge_info = GetEdgeInfo(edge_id);
+        switch (edge_info.type) {
+            case EdgeType::BUS:
+                items.push_back(edge_info);
+                break;
+            case EdgeType::BOARDING:
+                items.push_back({0.0, edge_info.bus_name, 0, edge_info.start_stop, edge_info.finish_stop});
+                break;
+            case EdgeType::RIDE:
+                items.back().weight += edge_info.weight;
+                items.back().span_count += edge_info.span_count;
+                items.back().finish_stop = edge_info.finish_stop;
+                break;
+            case EdgeType::ALIGHTING:
+                break;
+        }
+    }
+    path_info.bus_wait_time = routing_settings_.bus_wait_time;
+    path_info.total_time = RouteWeightToMinutes(*route_weight);
+    return true;
+}
+
+RouteMatrix TransportRouter::BuildRouteMatrix(const std::vector<std::string_view>& stops_from, 
+                                              const std::vector<std::string_view>& stops_to, bool with_itineraries) const {
+    RouteMatrix route_matrix;
+    if (!router_ && !raptor_) {
+        route_matrix.total_times.assign(stops_from.size(), std::vector<std::optional<double>>(stops_to.size()));
+        return route_matrix;
+    }
+    if (with_itineraries) {
+        route_matrix.total_times.resize(stops_from.size());
+        route_matrix.itineraries.resize(stops_from.size());
+        for (size_t i = 0; i < stops_from.size(); ++i) {
+            for (const std::string_view stop_to : stops_to) {
+                auto path_info = BuildPath(stops_from[i], stop_to);
+                route_matrix.total_times[i].push_back(path_info ? std::optional(path_info->total_time) : std::nullopt);
+                route_matrix.itineraries[i].push_back(std::move(path_info));
+            }
+        }
+        return route_matrix;
+    }
+    auto get_vertex_ids = [this](const std::vector<std::string_view>& stops) {
+        std::vector<graph::VertexId> vertex_ids;
+        vertex_ids.reserve(stops.size());
+        for (const std::string_view stop : stops) {
+            vertex_ids.push_back(graph_data_.vertex_id_by_stop_name.at(stop));
+        }
+        return vertex_ids;
+    };
+    graph::WeightsMatrix<RouteWeight> weights_matrix;
+    if (raptor_) {
+        const std::vector<graph::VertexId> vertex_ids_to = get_vertex_ids(stops_to);
+        const std::vector<uint32_t> stop_ids_to(vertex_ids_to.begin(), vertex_ids_to.end());
+        for (const graph::VertexId vertex_id_from : get_vertex_ids(stops_from)) {
+            weights_matrix.push_back(raptor_->BuildWeightsFrom(vertex_id_from, stop_ids_to));
+        }
+    } else {
+        weights_matrix = router_->BuildWeightsMatrix(get_vertex_ids(stops_from), get_vertex_ids(stops_to));
+    }
+    route_matrix.total_times.resize(stops_from.size());
+    for (size_t i = 0; i < stops_from.size(); ++i) {
+        for (const auto& weight : weights_matrix[i]) {
+            route_matrix.total_times[i].push_back(weight ? std::optional(RouteWeightToMinutes(*weight)) : std::nullopt);
+        }
+    }
+    return route_matrix;
+}
+
+std::vector<ReachableStop> TransportRouter::BuildReachableStops(std::string_view stop_from, double max_time) const {
+    std::vector<ReachableStop> reachable_stops;
+    if ((!router_ && !raptor_) || max_time < 0) {
+        return reachable_stops;
+    }
+    const graph::VertexId vertex_from = graph_data_.vertex_id_by_stop_name.at(stop_from);
+    const RouteWeight max_weight = MinutesToRouteWeightBound(max_time);
+    if (raptor_) {
+        thread_local std::vector<std::pair<uint32_t, RouteWeight>> stops;
+        raptor_->FindReachable(vertex_from, max_weight, stops);
+        for (const auto& [stop_id, weight] : stops) {
+            reachable_stops.push_back({graph_data_.stop_name_by_vertex_id[stop_id], RouteWeightToMinutes(weight)});
+        }
+        return reachable_stops;
+    }
+    thread_local std::vector<std::pair<graph::VertexId, RouteWeight>> vertices;
+    reachability_search_.FindReachable(vertex_from, max_weight, vertices);
+    for (const auto& [vertex_id, weight] : vertices) {
+        // Вершины «маршрут–остановка» остановками не являются
+        if (vertex_id < graph_data_.stop_name_by_vertex_id.size()) {
+            reachable_stops.push_back({graph_data_.stop_name_by_vertex_id[vertex_id], RouteWeightToMinutes(weight)});
+        }
+    }
+    return reachable_stops;
+}
+
+std::vector<PathInfo> TransportRouter::BuildParetoPaths(std::string_view stop_from, std::string_view stop_to) const {
+    std::vector<PathInfo> paths;
+    if (!raptor_) {
+        if (auto path_info = BuildPath(stop_from, stop_to)) {
+            paths.push_back(std::move(*path_info));
+        }
+        return paths;
+    }
+    for (const auto& journey : raptor_->BuildParetoJourneys(graph_data_.vertex_id_by_stop_name.at(stop_from), 
+                                                            graph_data_.vertex_id_by_stop_name.at(stop_to))) {
+        FillRaptorPathInfo(journey.legs, journey.weight, paths.emplace_back());
+    }
+    return paths;
+}
+
+bool TransportRouter::IsHeuristicAdmissible() const {
+    return heuristic_scale_ >= 1.0;
+}
+
+size_t TransportRouter::GetRemovedParallelEdgeCount() const {
+    return removed_parallel_edge_count_;
+}
+
+void TransportRouter::SaveSnapshot(const transport::TransportCatalogue& ctlg, const std::filesystem::path& path) const {
+    const size_t vertex_count = graph_data_.graph.GetVertexCount();
+    const size_t stop_count = graph_data_.vertex_id_by_stop_name.size();
+    const size_t edge_count = graph_data_.graph.GetEdgeCount();
+    
+    std::string names;
+    auto add_names = [&names](const std::vector<std::string_view>& names_by_id) {
+        std::vector<SnapshotName> snapshot_names;
+        snapshot_names.reserve(names_by_id.size());
+        for (const std::string_view name : names_by_id) {
+            snapshot_names.push_back({names.size(), name.size()});
+            names += name;
+        }
+        return snapshot_names;
+    };
+    const std::vector<SnapshotName> stop_names = add_names(graph_data_.stop_name_by_vertex_id);
+    const std::vector<SnapshotName> bus_names = add_names(graph_data_.bus_name_by_id);
+    std::vector<SnapshotEdgeRange> edge_ranges;
+    for (const EdgeRange& edge_range : graph_data_.edge_range_by_bus_id) {
+        edge_ranges.push_back({edge_range.begin, edge_range.end});
+    }
+    std::vector<SnapshotEdge> edges(edge_count);
+    for (graph::EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        const auto& edge = graph_data_.graph.GetEdge(edge_id);
+        edges[edge_id] = {static_cast<uint32_t>(edge.from), static_cast<uint32_t>(edge.to), edge.weight};
+    }
+    const EdgesTransportData& edges_data = graph_data_.edges_data;
+    const auto* all_pairs_router = dynamic_cast<const AllPairsRouter*>(router_.get());
+    const auto* wide_all_pairs_router = dynamic_cast<const WideAllPairsRouter*>(router_.get());
+    
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.router_type = static_cast<uint32_t>(routing_settings_.router_type);
+    header.graph_model = static_cast<uint32_t>(routing_settings_.graph_model);
+    header.bus_wait_time = routing_settings_.bus_wait_time;
+    header.bus_velocity = routing_settings_.bus_velocity;
+    header.heuristic_scale = heuristic_scale_;
+    header.weight_units_per_minute = ROUTE_WEIGHT_UNITS_PER_MINUTE;
+    header.cached_trees_limit = routing_settings_.cached_trees_limit;
+    header.threads_count = routing_settings_.threads_count;
+    header.compact_parallel_edges = routing_settings_.compact_parallel_edges;
+    header.vertex_count = vertex_count;
+    header.stop_count = stop_count;
+    header.bus_count = bus_names.size();
+    header.edge_count = edge_count;
+    header.names_size = names.size();
+    header.routes_table_edge_index_size = all_pairs_router        ? sizeof(AllPairsRouter::EdgeIndex)
+                                          : wide_all_pairs_router ? sizeof(WideAllPairsRouter::EdgeIndex)
+                                                                  : 0;
+    const RaptorRoutes no_raptor_routes;
+    const RaptorRoutes& raptor_routes = raptor_ ? raptor_->GetRoutes() : no_raptor_routes;
+    header.raptor_route_count = bus_id_by_raptor_route_.size();
+    header.raptor_route_stop_count = raptor_routes.stops.size();
+    header.catalogue_fingerprint = ComputeCatalogueFingerprint(ctlg);
+    
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Can't open file " + path.string());
+    }
+    WriteSnapshotSection(out, &header, 1);
+    WriteSnapshotSection(out, names.data(), names.size());
+    WriteSnapshotSection(out, stop_names.data(), stop_names.size());
+    WriteSnapshotSection(out, bus_names.data(), bus_names.size());
+    WriteSnapshotSection(out, edge_ranges.data(), edge_ranges.size());
+    WriteSnapshotSection(out, graph_data_.coordinates_by_vertex_id.data(), vertex_count);
+    WriteSnapshotSection(out, edges.data(), edges.size());
+    WriteSnapshotSection(out, edges_data.bus_ids.data(), edge_count);
+    WriteSnapshotSection(out, edges_data.span_counts.data(), edge_count);
+    WriteSnapshotSection(out, edges_data.start_stop_ids.data(), edge_count);
+    WriteSnapshotSection(out, edges_data.finish_stop_ids.data(), edge_count);
+    WriteSnapshotSection(out, edges_data.types.data(), edge_count);
+    if (raptor_) {
+        WriteSnapshotSection(out, raptor_routes.offsets.data(), raptor_routes.offsets.size());
+        WriteSnapshotSection(out, raptor_routes.stops.data(), raptor_routes.stops.size());
+        WriteSnapshotSection(out, raptor_routes.distances.data(), raptor_routes.distances.size());
+        WriteSnapshotSection(out, bus_id_by_raptor_route_.data(), bus_id_by_raptor_route_.size());
+    }
+    if (all_pairs_router) {
+        WriteRoutesTable(out, *all_pairs_router, vertex_count);
+    } else if (wide_all_pairs_router) {
+        WriteRoutesTable(out, *wide_all_pairs_router, vertex_count);
+    }
+    if (!out) {
+        throw std::runtime_error("Can't write file " + path.string());
+    }
+}
+
+void TransportRouter::LoadSnapshot(const transport::TransportCatalogue& ctlg, const std::filesystem::path& path) {
+    auto snapshot = std::make_unique<MappedFile>(path);
+    SnapshotReader reader(*snapshot);
+    const SnapshotHeader& header = *reader.ReadSection<SnapshotHeader>(1);
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("File " + path.string() + " is not a routing snapshot");
+    }
+    if (header.version != SNAPSHOT_VERSION) {
+        throw std::runtime_error("Unsupported routing snapshot version " + std::to_string(header.version));
+    }
+    if (header.weight_units_per_minute != ROUTE_WEIGHT_UNITS_PER_MINUTE) {
+        throw std::runtime_error("Routing snapshot was built with another route weight type");
+    }
+    if (header.stop_count > header.vertex_count) {
+        throw std::runtime_error("Routing snapshot is corrupted");
+    }
+    if (header.catalogue_fingerprint != ComputeCatalogueFingerprint(ctlg)) {
+        throw std::runtime_error("Routing snapshot was built from other base_requests");
+    }
+    const char* names = reader.ReadSection<char>(header.names_size);
+    const SnapshotName* stop_names = reader.ReadSection<SnapshotName>(header.stop_count);
+    const SnapshotName* bus_names = reader.ReadSection<SnapshotName>(header.bus_count);
+    const SnapshotEdgeRange* edge_ranges = reader.ReadSection<SnapshotEdgeRange>(header.bus_count);
+    const geo::Coordinates* coordinates = reader.ReadSection<geo::Coordinates>(header.vertex_count);
+    const SnapshotEdge* edges = reader.ReadSection<SnapshotEdge>(header.edge_count);
+    const uint32_t* bus_ids = reader.ReadSection<uint32_t>(header.edge_count);
+    const uint32_t* span_counts = reader.ReadSection<uint32_t>(header.edge_count);
+    const uint32_t* start_stop_ids = reader.ReadSection<uint32_t>(header.edge_count);
+    const uint32_t* finish_stop_ids = reader.ReadSection<uint32_t>(header.edge_count);
+    const EdgeType* types = reader.ReadSection<EdgeType>(header.edge_count);
+    const bool is_raptor = static_cast<RouterType>(header.router_type) == RouterType::RAPTOR;
+    RaptorRoutes raptor_routes;
+    std::vector<uint32_t> bus_id_by_raptor_route;
+    if (is_raptor) {
+        const uint32_t* offsets = reader.ReadSection<uint32_t>(header.raptor_route_count + 1);
+        const uint32_t* stops = reader.ReadSection<uint32_t>(header.raptor_route_stop_count);
+        const uint64_t* distances = reader.ReadSection<uint64_t>(header.raptor_route_stop_count);
+        const uint32_t* raptor_bus_ids = reader.ReadSection<uint32_t>(header.raptor_route_count);
+        raptor_routes.offsets.assign(offsets, offsets + header.raptor_route_count + 1);
+        raptor_routes.stops.assign(stops, stops + header.raptor_route_stop_count);
+        raptor_routes.distances.assign(distances, distances + header.raptor_route_stop_count);
+        bus_id_by_raptor_route.assign(raptor_bus_ids, raptor_bus_ids + header.raptor_route_count);
+        // Смещения задают разбиение массива остановок на маршруты, поэтому идут от нуля
+        // до его длины без убываний
+        if (raptor_routes.offsets.front() != 0 || raptor_routes.offsets.back() != header.raptor_route_stop_count
+            || !std::is_sorted(raptor_routes.offsets.begin(), raptor_routes.offsets.end())
+            || std::any_of(raptor_routes.stops.begin(), raptor_routes.stops.end(), [&header](uint32_t stop_id) {
+                   return stop_id >= header.stop_count;
+               })
+            || std::any_of(bus_id_by_raptor_route.begin(), bus_id_by_raptor_route.end(), [&header](uint32_t bus_id) {
+                   return bus_id >= header.bus_count;
+               })) {
+            throw std::runtime_error("Routing snapshot is corrupted");
+        }
+    }
+    // Разбиение таблицы всех пар может быть крупнее разбиения графа, если рёбра удалялись
+    const uint32_t* routes_table_component_by_vertex_id = nullptr;
+    const RouteWeight* weights = nullptr;
+    const AllPairsRouter::EdgeIndex* prev_edges = nullptr;
+    const WideAllPairsRouter::EdgeIndex* wide_prev_edges = nullptr;
+    if (header.routes_table_edge_index_size != 0) {
+        routes_table_component_by_vertex_id = reader.ReadSection<uint32_t>(header.vertex_count);
+        const size_t table_size = AllPairsRouter::ComputeTableSize(routes_table_component_by_vertex_id, header.vertex_count);
+        weights = reader.ReadSection<RouteWeight>(table_size);
+        if (header.routes_table_edge_index_size == sizeof(AllPairsRouter::EdgeIndex)) {
+            prev_edges = reader.ReadSection<AllPairsRouter::EdgeIndex>(table_size);
+        } else if (header.routes_table_edge_index_size == sizeof(WideAllPairsRouter::EdgeIndex)) {
+            wide_prev_edges = reader.ReadSection<WideAllPairsRouter::EdgeIndex>(table_size);
+        } else {
+            throw std::runtime_error("Routing snapshot is corrupted");
+        }
+    }
+    
+    auto get_name = [names, &header](const SnapshotName& name) {
+        if (name.offset > header.names_size || header.names_size - name.offset < name.size) {
+            throw std::runtime_error("Routing snapshot is corrupted");
+        }
+        return std::string_view(names + name.offset, name.size);
+    };
+    
+    GraphAndItsTransportData<RouteWeight> graph_data{graph::DirectedWeightedGraph<RouteWeight>(header.vertex_count)};
+    for (graph::VertexId vertex_id = 0; vertex_id < header.stop_count; ++vertex_id) {
+        graph_data.stop_name_by_vertex_id.push_back(get_name(stop_names[vertex_id]));
+        graph_data.vertex_id_by_stop_name[graph_data.stop_name_by_vertex_id.back()] = vertex_id;
+    }
+    for (size_t bus_id = 0; bus_id < header.bus_count; ++bus_id) {
+        const SnapshotEdgeRange& edge_range = edge_ranges[bus_id];
+        if (edge_range.begin > edge_range.end || edge_range.end > header.edge_count) {
+            throw std::runtime_error("Routing snapshot is corrupted");
+        }
+        graph_data.bus_name_by_id.push_back(get_name(bus_names[bus_id]));
+        graph_data.bus_id_by_name[graph_data.bus_name_by_id.back()] = bus_id;
+        graph_data.edge_range_by_bus_id.push_back({edge_range.begin, edge_range.end});
+    }
+    graph_data.coordinates_by_vertex_id.assign(coordinates, coordinates + header.vertex_count);
+    for (graph::EdgeId edge_id = 0; edge_id < header.edge_count; ++edge_id) {
+        const SnapshotEdge& edge = edges[edge_id];
+        if (edge.from >= header.vertex_count || edge.to >= header.vertex_count || bus_ids[edge_id] >= header.bus_count
+            || start_stop_ids[edge_id] >= header.stop_count || finish_stop_ids[edge_id] >= header.stop_count
+            || types[edge_id] > EdgeType::ALIGHTING) {
+            throw std::runtime_error("Routing snapshot is corrupted");
+        }
+        graph_data.graph.AddEdge({edge.from, edge.to, edge.weight});
+    }
+    // Рёбра прежних версий изменённых маршрутов сохраняют свои EdgeId, но в граф не входят,
+    // а вершины «маршрут–остановка» без живых рёбер остались от прежних версий
+    size_t dead_edge_count = 0;
+    std::vector<bool> is_vertex_alive(header.vertex_count, false);
+    std::fill(is_vertex_alive.begin(), is_vertex_alive.begin() + header.stop_count, true);
+    for (graph::EdgeId edge_id = 0; edge_id < header.edge_count; ++edge_id) {
+        const EdgeRange& edge_range = graph_data.edge_range_by_bus_id[bus_ids[edge_id]];
+        if (edge_id < edge_range.begin || edge_id >= edge_range.end) {
+            graph_data.graph.RemoveEdge(edge_id);
+            ++dead_edge_count;
+        } else {
+            is_vertex_alive[edges[edge_id].from] = true;
+            is_vertex_alive[edges[edge_id].to] = true;
+        }
+    }
+    const size_t removed_parallel_edge_count = header.compact_parallel_edges ? graph_data.graph.RemoveParallelEdges() : 0;
+    graph_data.graph.Freeze();
+    graph_data.component_by_vertex_id = graph::FindComponents(graph_data.graph).component_by_vertex;
+    EdgesTransportData& edges_data = graph_data.edges_data;
+    edges_data.bus_ids.assign(bus_ids, bus_ids + header.edge_count);
+    edges_data.span_counts.assign(span_counts, span_counts + header.edge_count);
+    edges_data.start_stop_ids.assign(start_stop_ids, start_stop_ids + header.edge_count);
+    edges_data.finish_stop_ids.assign(finish_stop_ids, finish_stop_ids + header.edge_count);
+    edges_data.types.assign(types, types + header.edge_count);
+    
+    router_.reset();
+    vertex_id_by_stop_id_.clear();
+    raptor_.reset();
+    routing_settings_.router_type = static_cast<RouterType>(header.router_type);
+    routing_settings_.graph_model = static_cast<GraphModel>(header.graph_model);
+    routing_settings_.bus_wait_time = header.bus_wait_time;
+    routing_settings_.bus_velocity = header.bus_velocity;
+    routing_settings_.cached_trees_limit = header.cached_trees_limit;
+    routing_settings_.threads_count = header.threads_count;
+    routing_settings_.compact_parallel_edges = header.compact_parallel_edges;
+    removed_parallel_edge_count_ = removed_parallel_edge_count;
+    dead_edge_count_ = dead_edge_count;
+    dead_vertex_count_ = std::count(is_vertex_alive.begin(), is_vertex_alive.end(), false);
+    heuristic_scale_ = header.heuristic_scale;
+    graph_data_ = std::move(graph_data);
+    next_route_stop_vertex_id_ = header.vertex_count;
+    snapshot_ = std::move(snapshot);
+    if (prev_edges) {
+        router_ = std::make_unique<AllPairsRouter>(graph_data_.graph, routes_table_component_by_vertex_id,
+                                                   weights, prev_edges, routing_settings_.threads_count);
+    } else if (wide_prev_edges) {
+        router_ = std::make_unique<WideAllPairsRouter>(graph_data_.graph, routes_table_component_by_vertex_id,
+                                                       weights, wide_prev_edges, routing_settings_.threads_count);
+    } else {
+        router_ = MakeRoutingEngine();
+    }
+    if (is_raptor) {
+        raptor_ = std::make_unique<Raptor<RouteWeight>>(header.stop_count, std::move(raptor_routes), MakeRaptorLegWeight());
+        bus_id_by_raptor_route_ = std::move(bus_id_by_raptor_route);
+    }
+}
+
+std::unique_ptr<graph::RoutingEngine<RouteWeight>> TransportRouter::MakeRoutingEngine() const {
+    switch (routing_settings_.router_type) {
+        case RouterType::ALL_PAIRS:
+            if (graph_data_.graph.GetEdgeCount() > AllPairsRouter::MAX_EDGE_COUNT) {
+                return std::make_unique<WideAllPairsRouter>(graph_data_.graph, routing_settings_.threads_count);
+            }
+            return std::make_unique<AllPairsRouter>(graph_data_.graph, routing_settings_.threads_count);
+        case RouterType::ON_DEMAND:
+            return std::make_unique<graph::DijkstraRouter<RouteWeight>>(graph_data_.graph, routing_settings_.cached_trees_limit);
+        case RouterType::CONTRACTION_HIERARCHY:
+            return std::make_unique<graph::ContractionHierarchy<RouteWeight>>(graph_data_.graph);
+        case RouterType::A_STAR:
+            return std::make_unique<graph::AStarRouter<RouteWeight>>(graph_data_.graph, MakeGeoHeuristic());
+        case RouterType::RAPTOR:
+            return nullptr;
+        case RouterType::HUB_LABELS:
+            return std::make_unique<graph::HubLabels<RouteWeight>>(graph_data_.graph, routing_settings_.threads_count);
+    }
+    throw std::logic_error("Unknown router type");
+}
+
+double TransportRouter::ComputeHeuristicScale(const transport::TransportCatalogue& ctlg) const {
+    double heuristic_scale = 1.0;
+    for (const auto [route_name, route_ptr] : ctlg.GetAllRoutes()) {
+        const auto& vec_stops = route_ptr->stops;
+        for (size_t i = 1; i < vec_stops.size(); ++i) {
+            const double geo_distance = geo::ComputeDistance(ctlg.GetStop(vec_stops[i - 1]).coordinates, 
+                                                             ctlg.GetStop(vec_stops[i]).coordinates);
+            if (geo_distance <= 0.0) {
+                continue;
+            }
+            heuristic_scale = std::min(heuristic_scale, ctlg.GetDistance(vec_stops[i - 1], vec_stops[i]) / geo_distance);
+            if (!route_ptr->is_roundtrip) {
+                heuristic_scale = std::min(heuristic_scale, ctlg.GetDistance(vec_stops[i], vec_stops[i - 1]) / geo_distance);
+            }
+        }
+    }
+    return heuristic_scale;
+}
+
+graph::AStarRouter<RouteWeight>::Heuristic TransportRouter::MakeGeoHeuristic() const {
+    const int meters_in_km = 1000;
+    const int seconds_in_min = 60;
+    const double bus_velocity = routing_settings_.bus_velocity;
+    const double bus_wait_time = routing_settings_.bus_wait_time;
+    const size_t stop_count = graph_data_.vertex_id_by_stop_name.size();
+    const auto& coordinates_by_vertex_id = graph_data_.coordinates_by_vertex_id;
+    // Если дорога где-то короче расстояния по прямой, оценка ужимается до допустимой.
+    // Коэффициент читается при каждой оценке: обновления маршрутов могут его уменьшить
+    const double& heuristic_scale = heuristic_scale_;
+    return [&coordinates_by_vertex_id, &heuristic_scale, bus_velocity, bus_wait_time, stop_count](graph::VertexId vertex, 
+                                                                                                  graph::VertexId target) {
+        const double minutes_per_meter = heuristic_scale * seconds_in_min / (meters_in_km * bus_velocity);
+        const double ride_time = geo::ComputeDistance(coordinates_by_vertex_id[vertex], 
+                                                      coordinates_by_vertex_id[target]) * minutes_per_meter;
+        // Из вершины-остановки в другую остановку не уехать, не дождавшись автобуса
+        const double estimate = vertex < stop_count && vertex != target ? ride_time + bus_wait_time : ride_time;
+        // Целая оценка округляется вниз, а веса рёбер вверх, так что она остаётся согласованной
+        if constexpr (std::is_integral_v<RouteWeight>) {
+            return static_cast<RouteWeight>(std::floor(estimate * ROUTE_WEIGHT_UNITS_PER_MINUTE));
+        } else {
+            return estimate;
+        }
+    };
+}
+
+void TransportRouter::AddRouteEdgesInGraph(const transport::TransportCatalogue& ctlg, const Route& route, uint32_t bus_id) {
+    RouteEdges route_edges;
+    BuildRouteEdges(ctlg, route, bus_id, next_route_stop_vertex_id_, route_edges);
+    if (routing_settings_.graph_model == GraphModel::ROUTE_STOPS) {
+        next_route_stop_vertex_id_ += route.is_roundtrip ? route.stops.size() : route.stops.size() * 2;
+    }
+    AddRouteEdgesInGraph(route_edges, bus_id);
+}
+
+void TransportRouter::AddRouteEdgesInGraph(RouteEdges& route_edges, uint32_t bus_id) {
+    const graph::EdgeId first_edge_id = graph_data_.graph.GetEdgeCount();
+    for (const auto& edge : route_edges.edges) {
+        graph_data_.graph.AddEdge(edge);
+    }
+    EdgesTransportData& edges_data = graph_data_.edges_data;
+    const auto append = [](auto& column, const auto& route_column) {
+        column.insert(column.end(), route_column.begin(), route_column.end());
+    };
+    append(edges_data.bus_ids, route_edges.edges_data.bus_ids);
+    append(edges_data.span_counts, route_edges.edges_data.span_counts);
+    append(edges_data.start_stop_ids, route_edges.edges_data.start_stop_ids);
+    append(edges_data.finish_stop_ids, route_edges.edges_data.finish_stop_ids);
+    append(edges_data.types, route_edges.edges_data.types);
+    graph_data_.edge_range_by_bus_id[bus_id] = {first_edge_id, graph_data_.graph.GetEdgeCount()};
+}
+
+size_t TransportRouter::CountRouteEdges(const Route& route) const {
+    const size_t stop_count = route.stops.size();
+    const size_t direction_count = route.is_roundtrip ? 1 : 2;
+    if (stop_count == 0) {
+        return 0;
+    }
+    if (routing_settings_.graph_model == GraphModel::ROUTE_STOPS) {
+        return direction_count * 3 * (stop_count - 1);
+    }
+    return direction_count * stop_count * (stop_count - 1) / 2;
+}
+
+// Номера вершин и расстояния между соседними остановками берутся по одному разу на остановку,
+// а не на каждое ребро. Пишет только в свои рёбра и в координаты своих вершин
+// «маршрут–остановка», поэтому разные автобусы можно строить одновременно
+void TransportRouter::BuildRouteEdges(const transport::TransportCatalogue& ctlg, const Route& route, uint32_t bus_id,
+                                      graph::VertexId first_route_stop_vertex_id, RouteEdges& route_edges) {
+    std::vector<graph::VertexId> stop_ids;
+    stop_ids.reserve(route.stops.size());
+    for (const StopId stop_id : route.stops) {
+        stop_ids.push_back(vertex_id_by_stop_id_.at(stop_id));
+    }
+    std::vector<int> distances;
+    const auto fill_distances = [&](auto stops_begin, auto stops_end) {
+        distances.clear();
+        for (auto it = stops_begin; it != stops_end && std::next(it) != stops_end; ++it) {
+            distances.push_back(ctlg.GetDistance(*it, *std::next(it)));
+        }
+    };
+    const bool is_route_stops = routing_settings_.graph_model == GraphModel::ROUTE_STOPS;
+    fill_distances(route.stops.begin(), route.stops.end());
+    if (is_route_stops) {
+        BuildRouteStopsDirectionEdges(stop_ids, distances, bus_id, first_route_stop_vertex_id, route_edges);
+    } else {
+        BuildRouteDirectionEdges(stop_ids, distances, bus_id, route_edges);
+    }
+    if (route.is_roundtrip) {
+        return;
+    }
+    std::reverse(stop_ids.begin(), stop_ids.end());
+    fill_distances(route.stops.rbegin(), route.stops.rend());
+    if (is_route_stops) {
+        BuildRouteStopsDirectionEdges(stop_ids, distances, bus_id, first_route_stop_vertex_id + stop_ids.size(), route_edges);
     } else {
-        std::vector<EdgeInfo> items;
-        for (graph::EdgeId edge_id : route_info->edges) {
-            items.push_back(graph_data_.edge_info_by_edge_id.at(edge_id));
+        BuildRouteDirectionEdges(stop_ids, distances, bus_id, route_edges);
+    }
+}
+
+void TransportRouter::BuildRouteDirectionEdges(const std::vector<graph::VertexId>& stop_ids, const std::vector<int>& distances,
+                                               uint32_t bus_id, RouteEdges& route_edges) const {
+    const int meters_in_km = 1000;
+    const int seconds_in_min = 60;
+    for (size_t index_stop_from = 0; index_stop_from < stop_ids.size(); ++index_stop_from) {
+        uint32_t total_distance = 0;
+        for (size_t index_stop_to = index_stop_from + 1; index_stop_to < stop_ids.size(); ++index_stop_to) {
+            const graph::VertexId id_stop_from = stop_ids[index_stop_from];
+            const graph::VertexId id_stop_to = stop_ids[index_stop_to];
+            total_distance += distances[index_stop_to - 1];
+
+            const RouteWeight weight = MinutesToRouteWeight(((total_distance * seconds_in_min) / 
+                                                             (meters_in_km * routing_settings_.bus_velocity)) 
+                                                            + routing_settings_.bus_wait_time);
+            const int span_count = index_stop_to - index_stop_from;
+            AddEdgeInRouteEdges(route_edges, {id_stop_from, id_stop_to, weight}, bus_id, span_count, id_stop_from, id_stop_to);
+        }
+    }
+}
+
+void TransportRouter::BuildRouteStopsDirectionEdges(const std::vector<graph::VertexId>& stop_ids, const std::vector<int>& distances,
+                                                    uint32_t bus_id, graph::VertexId first_route_stop_vertex_id, 
+                                                    RouteEdges& route_edges) {
+    const int meters_in_km = 1000;
+    const int seconds_in_min = 60;
+    for (size_t index_stop = 0; index_stop < stop_ids.size(); ++index_stop) {
+        const graph::VertexId id_stop = stop_ids[index_stop];
+        const graph::VertexId id_route_stop = first_route_stop_vertex_id + index_stop;
+        graph_data_.coordinates_by_vertex_id[id_route_stop] = graph_data_.coordinates_by_vertex_id[id_stop];
+        if (index_stop + 1 < stop_ids.size()) {
+            AddEdgeInRouteEdges(route_edges, {id_stop, id_route_stop, MinutesToRouteWeight(routing_settings_.bus_wait_time)},
+                                bus_id, 0, id_stop, id_stop, EdgeType::BOARDING);
+        }
+        if (index_stop > 0) {
+            const RouteWeight weight = MinutesToRouteWeight((distances[index_stop - 1] * seconds_in_min) / 
+                                                            (meters_in_km * routing_settings_.bus_velocity));
+            AddEdgeInRouteEdges(route_edges, {id_route_stop - 1, id_route_stop, weight},
+                                bus_id, 1, stop_ids[index_stop - 1], id_stop, EdgeType::RIDE);
+            AddEdgeInRouteEdges(route_edges, {id_route_stop, id_stop, RouteWeight{}}, bus_id, 0, id_stop, id_stop, EdgeType::ALIGHTING);
+        }
+    }
+}
+
+void TransportRouter::AddRouteInRaptorRoutes(const transport::TransportCatalogue& ctlg, const Route& route, uint32_t bus_id,
+                                             RaptorRoutes& raptor_routes) {
+    const auto& vec_stops = route.stops;
+    AddRouteDirectionInRaptorRoutes(ctlg, vec_stops.begin(), vec_stops.size(), bus_id, raptor_routes);
+    if (!route.is_roundtrip) {
+        AddRouteDirectionInRaptorRoutes(ctlg, vec_stops.rbegin(), vec_stops.size(), bus_id, raptor_routes);
+    }
+}
+
+Raptor<RouteWeight>::LegWeight TransportRouter::MakeRaptorLegWeight() const {
+    const int meters_in_km = 1000;
+    const int seconds_in_min = 60;
+    // Вес поездки считается так же, как вес ребра модели stop_pairs, поэтому времена путей совпадают
+    return [bus_velocity = routing_settings_.bus_velocity, bus_wait_time = routing_settings_.bus_wait_time](uint64_t distance) {
+        return MinutesToRouteWeight(((distance * seconds_in_min) / (meters_in_km * bus_velocity)) + bus_wait_time);
+    };
+}
+
+void TransportRouter::FillRaptorPathInfo(const std::vector<Raptor<RouteWeight>::Leg>& legs, RouteWeight weight, 
+                                         PathInfo& path_info) const {
+    const RaptorRoutes& raptor_routes = raptor_->GetRoutes();
+    for (const auto& leg : legs) {
+        const uint32_t route_offset = raptor_routes.offsets[leg.route];
+        path_info.items.push_back({RouteWeightToMinutes(leg.weight - MinutesToRouteWeight(routing_settings_.bus_wait_time)),
+                                   graph_data_.bus_name_by_id[bus_id_by_raptor_route_[leg.route]],
+                                   static_cast<int>(leg.alight_position - leg.board_position),
+                                   graph_data_.stop_name_by_vertex_id[raptor_routes.stops[route_offset + leg.board_position]],
+                                   graph_data_.stop_name_by_vertex_id[raptor_routes.stops[route_offset + leg.alight_position]]});
+    }
+    path_info.bus_wait_time = routing_settings_.bus_wait_time;
+    path_info.total_time = RouteWeightToMinutes(weight);
+}
+
+bool TransportRouter::ReplaceRouteEdges(const transport::TransportCatalogue& ctlg, std::string_view route_name,
+                                        std::vector<graph::EdgeId>& added_edges, 
+                                        std::vector<graph::EdgeId>& removed_edges) {
+    const Route* route = ctlg.GetRoute(route_name);
+    if (route) {
+        for (const StopId stop_id : route->stops) {
+            if (vertex_id_by_stop_id_.at(stop_id) == NO_VERTEX) {
+                return false;
+            }
+        }
+    }
+    // Вершины «маршрут–остановка» одного автобуса идут подряд сразу за вершинами-остановками
+    const graph::VertexId stop_count = graph_data_.vertex_id_by_stop_name.size();
+    graph::VertexId old_route_stops_begin = graph_data_.graph.GetVertexCount();
+    graph::VertexId old_route_stops_end = 0;
+    auto bus_it = graph_data_.bus_id_by_name.find(route_name);
+    if (bus_it != graph_data_.bus_id_by_name.end()) {
+        EdgeRange& edge_range = graph_data_.edge_range_by_bus_id[bus_it->second];
+        for (graph::EdgeId edge_id = edge_range.begin; edge_id < edge_range.end; ++edge_id) {
+            for (const graph::VertexId vertex : {graph_data_.graph.GetEdge(edge_id).from, graph_data_.graph.GetEdge(edge_id).to}) {
+                if (vertex >= stop_count) {
+                    old_route_stops_begin = std::min(old_route_stops_begin, vertex);
+                    old_route_stops_end = std::max(old_route_stops_end, vertex + 1);
+                }
+            }
+            graph_data_.graph.RemoveEdge(edge_id);
+            removed_edges.push_back(edge_id);
+        }
+        dead_edge_count_ += edge_range.end - edge_range.begin;
+        edge_range = {};
+    }
+    const size_t old_route_stop_count = old_route_stops_begin < old_route_stops_end 
+                                        ? old_route_stops_end - old_route_stops_begin : 0;
+    if (!route) {
+        dead_vertex_count_ += old_route_stop_count;
+        return true;
+    }
+    if (bus_it == graph_data_.bus_id_by_name.end()) {
+        const uint32_t bus_id = graph_data_.bus_name_by_id.size();
+        graph_data_.bus_name_by_id.push_back(route->name);
+        graph_data_.edge_range_by_bus_id.emplace_back();
+        bus_it = graph_data_.bus_id_by_name.emplace(route->name, bus_id).first;
+    }
+    if (routing_settings_.graph_model == GraphModel::ROUTE_STOPS) {
+        // Новая версия маршрута занимает вершины прежней, если в них помещается, иначе
+        // получает новые, а прежние остаются изолированными до полной перестройки графа
+        const size_t route_stop_count = route->is_roundtrip ? route->stops.size() : route->stops.size() * 2;
+        if (route_stop_count <= old_route_stop_count) {
+            next_route_stop_vertex_id_ = old_route_stops_begin;
+            dead_vertex_count_ += old_route_stop_count - route_stop_count;
+        } else {
+            dead_vertex_count_ += old_route_stop_count;
+            next_route_stop_vertex_id_ = graph_data_.graph.GetVertexCount();
+            for (size_t i = 0; i < route_stop_count; ++i) {
+                graph_data_.graph.AddVertex();
+            }
+            graph_data_.coordinates_by_vertex_id.resize(graph_data_.graph.GetVertexCount());
+        }
+    }
+    AddRouteEdgesInGraph(ctlg, *route, bus_it->second);
+    const EdgeRange& edge_range = graph_data_.edge_range_by_bus_id[bus_it->second];
+    for (graph::EdgeId edge_id = edge_range.begin; edge_id < edge_range.end; ++edge_id) {
+        added_edges.push_back(edge_id);
+    }
+    return true;
+}
+
+void TransportRouter::UpdateRoutes(const transport::TransportCatalogue& ctlg,
+                                   const std::vector<std::string_view>& route_names) {
+    if (IsRebuiltOnUpdate()) {
+        UploadTransportData(ctlg);
+        return;
+    }
+    if (vertex_id_by_stop_id_.size() != ctlg.GetStopCount()) {
+        MapStopIdsToVertexIds(ctlg);
+    }
+    std::vector<graph::EdgeId> added_edges;
+    std::vector<graph::EdgeId> removed_edges;
+    for (const std::string_view route_name : route_names) {
+        if (!ReplaceRouteEdges(ctlg, route_name, added_edges, removed_edges)) {
+            UploadTransportData(ctlg);
+            return;
+        }
+    }
+    // Мёртвые рёбра и вершины занимают память и замедляют поиски и перестройки движков;
+    // когда их больше половины, граф дешевле построить заново
+    if (dead_edge_count_ * 2 > graph_data_.graph.GetEdgeCount() 
+        || dead_vertex_count_ * 2 > graph_data_.graph.GetVertexCount()) {
+        UploadTransportData(ctlg);
+        return;
+    }
+    ApplyEdgesUpdate(ctlg, added_edges, removed_edges);
+}
+
+// Удалённое при сжатии ребро может снова стать самым лёгким, так что сжатый граф строится
+// заново. Иерархия сжатия обновляться не умеет, а её построение с нуля по свежему графу
+// дешевле, чем по графу с мёртвыми рёбрами. Данные RAPTOR — лишь плоские массивы маршрутов,
+// они собираются за миллисекунды
+bool TransportRouter::IsRebuiltOnUpdate() const {
+    return routing_settings_.compact_parallel_edges || raptor_
+           || routing_settings_.router_type == RouterType::CONTRACTION_HIERARCHY;
+}
+
+void TransportRouter::ApplyEdgesUpdate(const transport::TransportCatalogue& ctlg, 
+                                       const std::vector<graph::EdgeId>& added_edges, 
+                                       const std::vector<graph::EdgeId>& removed_edges) {
+    graph_data_.graph.Freeze();
+    // Удалённые рёбра оставляют разбиение верным, хоть и более крупным; пересчёт нужен,
+    // только если появились вершины или новое ребро соединило разные компоненты
+    std::vector<uint32_t>& component_by_vertex_id = graph_data_.component_by_vertex_id;
+    if (component_by_vertex_id.size() != graph_data_.graph.GetVertexCount()
+        || std::any_of(added_edges.begin(), added_edges.end(), [this, &component_by_vertex_id](graph::EdgeId edge_id) {
+               const auto& edge = graph_data_.graph.GetEdge(edge_id);
+               return component_by_vertex_id[edge.from] != component_by_vertex_id[edge.to];
+           })) {
+        component_by_vertex_id = graph::FindComponents(graph_data_.graph).component_by_vertex;
+    }
+    heuristic_scale_ = ComputeHeuristicScale(ctlg);
+    if (!router_->UpdateEdges(added_edges, removed_edges)) {
+        router_ = MakeRoutingEngine();
+    }
+}
+
+void TransportRouter::AddEdgeInRouteEdges(RouteEdges& route_edges, const graph::Edge<RouteWeight>& edge, uint32_t bus_id, 
+                                          int span_count, graph::VertexId start_stop_id, graph::VertexId finish_stop_id, 
+                                          EdgeType type) {
+    route_edges.edges.push_back(edge);
+    EdgesTransportData& edges_data = route_edges.edges_data;
+    edges_data.bus_ids.push_back(bus_id);
+    edges_data.span_counts.push_back(span_count);
+    edges_data.start_stop_ids.push_back(start_stop_id);
+    edges_data.finish_stop_ids.push_back(finish_stop_id);
+    edges_data.types.push_back(type);
+}
+
+EdgeInfo TransportRouter::GetEdgeInfo(graph::EdgeId edge_id) const {
+    const EdgesTransportData& edges_data = graph_data_.edges_data;
+    const EdgeType type = edges_data.types[edge_id];
+    double weight = 0.0;
+    if (type == EdgeType::BUS) {
+        weight = RouteWeightToMinutes(graph_data_.graph.GetEdge(edge_id).weight 
+                                      - MinutesToRouteWeight(routing_settings_.bus_wait_time));
+    } else if (type == EdgeType::RIDE) {
+        weight = RouteWeightToMinutes(graph_data_.graph.GetEdge(edge_id).weight);
+    }
+    return {weight, graph_data_.bus_name_by_id[edges_data.bus_ids[edge_id]], static_cast<int>(edges_data.span_counts[edge_id]),
+            graph_data_.stop_name_by_vertex_id[edges_data.start_stop_ids[edge_id]],
+            graph_data_.stop_name_by_vertex_id[edges_data.finish_stop_ids[edge_id]], type};
+}
+
+size_t TransportRouter::CountRouteStopVertices(const transport::TransportCatalogue& ctlg) const {
+    if (routing_settings_.graph_model != GraphModel::ROUTE_STOPS) {
+        return 0;
+    }
+    size_t route_stop_count = 0;
+    for (const auto [route_name, route_ptr] : ctlg.GetAllRoutes()) {
+        route_stop_count += route_ptr->is_roundtrip ? route_ptr->stops.size() : route_ptr->stops.size() * 2;
+    }
+    return route_stop_count;
+}
+
+void TransportRouter::MapStopIdsToVertexIds(const transport::TransportCatalogue& ctlg) {
+    vertex_id_by_stop_id_.assign(ctlg.GetStopCount(), NO_VERTEX);
+    for (const auto [stop_name, stop_ptr] : ctlg.GetAllStops()) {
+        const auto it = graph_data_.vertex_id_by_stop_name.find(stop_name);
+        if (it != graph_data_.vertex_id_by_stop_name.end()) {
+            vertex_id_by_stop_id_[stop_ptr->id] = it->second;
         }
-        return PathInfo{items, routing_settings_.bus_wait_time, route_info->weight};
     }
 }
 
@@ -45,6 +1104,8 @@ void TransportRouter::AddVertexIdsInGraphData(const std::unordered_map<std::stri
     size_t index_number_of_stop = 0;
     for (const auto [stop_name, stop_ptr] : all_stops) {
         graph_data_.vertex_id_by_stop_name[stop_ptr->name] = index_number_of_stop;
+        graph_data_.stop_name_by_vertex_id.push_back(stop_ptr->name);
+        graph_data_.coordinates_by_vertex_id[index_number_of_stop] = stop_ptr->coordinates;
         ++index_number_of_stop;
     }
 }
@@ -1,15 +1,69 @@
 #pragma once
 
+#include "a_star_router.h"
+#include "contraction_hierarchy.h"
+#include "dijkstra_router.h"
+#include "geo.h"
+#include "hub_labels.h"
+#include "mapped_file.h"
+#include "raptor.h"
+#include "reachability.h"
 #include "router.h"
 #include "transport_catalogue.h"
 
+#include <cstdint>
+#include <filesystem>
+#include <limits>
 #include <memory>
+#include <type_traits>
 
 namespace transport {
 
+// Вес рёбер и путей графа. По умолчанию — минуты в double; при сборке с
+// -DTRANSPORT_ROUTER_FIXED_POINT_WEIGHTS — целые десятые доли секунды в int32_t,
+// так что таблица весов всех пар вдвое меньше. Вес ребра округляется вверх: время
+// маршрута не меньше точного и больше его не более чем на 0,1 с на ребро пути
+#ifdef TRANSPORT_ROUTER_FIXED_POINT_WEIGHTS
+using RouteWeight = int32_t;
+#else
+using RouteWeight = double;
+#endif
+
+inline constexpr double ROUTE_WEIGHT_UNITS_PER_MINUTE = std::is_integral_v<RouteWeight> ? 600.0 : 1.0;
+
+RouteWeight MinutesToRouteWeight(double minutes);
+double RouteWeightToMinutes(RouteWeight weight);
+
+enum class RouterType {
+    ALL_PAIRS,
+    ON_DEMAND,
+    CONTRACTION_HIERARCHY,
+    A_STAR,
+    RAPTOR,
+    HUB_LABELS,
+};
+
+enum class GraphModel {
+    STOP_PAIRS,
+    ROUTE_STOPS,
+};
+
 struct RoutingSettings {
     double bus_velocity = 0.0;
     int bus_wait_time = 0;
+    RouterType router_type = RouterType::ALL_PAIRS;
+    GraphModel graph_model = GraphModel::STOP_PAIRS;
+    size_t cached_trees_limit = graph::DijkstraRouter<RouteWeight>::DEFAULT_CACHED_TREES_LIMIT;
+    size_t threads_count = parallel::GetHardwareThreadsCount();
+    // Из параллельных рёбер между парой вершин в графе остаётся одно, самое лёгкое
+    bool compact_parallel_edges = false;
+};
+
+enum class EdgeType : uint8_t {
+    BUS,
+    BOARDING,
+    RIDE,
+    ALIGHTING,
 };
 
 struct EdgeInfo {
@@ -18,13 +72,37 @@ struct EdgeInfo {
     int span_count = 0;
     std::string_view start_stop;
     std::string_view finish_stop;
+    EdgeType type = EdgeType::BUS;
+};
+    
+// Данные рёбер по столбцам, индекс — EdgeId; остановки задаются номерами их вершин,
+// автобусы — номерами в bus_name_by_id, вес восстанавливается по весу ребра графа
+struct EdgesTransportData {
+    std::vector<uint32_t> bus_ids = {};
+    std::vector<uint32_t> span_counts = {};
+    std::vector<uint32_t> start_stop_ids = {};
+    std::vector<uint32_t> finish_stop_ids = {};
+    std::vector<EdgeType> types = {};
+};
+    
+// Рёбра одного автобуса добавляются в граф подряд
+struct EdgeRange {
+    graph::EdgeId begin = 0;
+    graph::EdgeId end = 0;
 };
     
 template <typename Weight>    
 struct GraphAndItsTransportData {
     graph::DirectedWeightedGraph<Weight> graph;
     std::unordered_map<std::string_view, graph::VertexId> vertex_id_by_stop_name = {};
-    std::unordered_map<graph::EdgeId, EdgeInfo> edge_info_by_edge_id = {};
+    std::vector<std::string_view> stop_name_by_vertex_id = {};
+    std::vector<std::string_view> bus_name_by_id = {};
+    std::unordered_map<std::string_view, uint32_t> bus_id_by_name = {};
+    std::vector<EdgeRange> edge_range_by_bus_id = {};
+    EdgesTransportData edges_data = {};
+    std::vector<geo::Coordinates> coordinates_by_vertex_id = {};
+    // Компоненты связности графа; между остановками разных компонент маршрута нет
+    std::vector<uint32_t> component_by_vertex_id = {};
 };
 
 struct PathInfo {
@@ -33,44 +111,131 @@ struct PathInfo {
     double total_time = 0;
 };
 
+struct ReachableStop {
+    std::string_view stop_name;
+    double time = 0;
+};
+
+// Строки — остановки отправления, столбцы — остановки прибытия; пустое значение — пути нет
+struct RouteMatrix {
+    std::vector<std::vector<std::optional<double>>> total_times;
+    std::vector<std::vector<std::optional<PathInfo>>> itineraries = {};
+};
+
 class TransportRouter {   
 public:
     void SetSettings(RoutingSettings routing_settings);
+    const RoutingSettings& GetSettings() const;
     void UploadTransportData(const transport::TransportCatalogue& catalogue);
+    // Обновляют только рёбра затронутых автобусов и данные маршрутизатора. Заново строятся
+    // иерархия сжатия, сжатый граф и RAPTOR, а также граф, если изменение затрагивает
+    // неизвестные ему остановки или больше половины рёбер или вершин остались от прежних
+    // версий маршрутов
+    void UpdateRoute(const transport::TransportCatalogue& catalogue, std::string_view route_name);
+    void UpdateDistance(const transport::TransportCatalogue& catalogue, std::string_view stop_from, std::string_view stop_to);
+    // Несколько изменённых расстояний за одно обновление: автобус, в маршруте которого
+    // есть несколько пар, перестраивается один раз
+    void UpdateDistances(const transport::TransportCatalogue& catalogue,
+                         const std::vector<std::pair<std::string_view, std::string_view>>& stop_pairs);
+    // Изменённые маршруты и расстояния вместе, тоже с одной перестройкой каждого автобуса
+    void UpdateRoutesAndDistances(const transport::TransportCatalogue& catalogue,
+                                  const std::vector<std::string_view>& route_names,
+                                  const std::vector<std::pair<std::string_view, std::string_view>>& stop_pairs);
     std::optional<PathInfo> BuildPath(std::string_view stop_from, std::string_view stop_to) const;    
+    // Заполняет path_info, переиспользуя память его items; false — пути нет
+    bool BuildPath(std::string_view stop_from, std::string_view stop_to, PathInfo& path_info) const;
+    RouteMatrix BuildRouteMatrix(const std::vector<std::string_view>& stops_from, 
+                                 const std::vector<std::string_view>& stops_to, bool with_itineraries = false) const;
+    // Остановки, до которых можно доехать не дольше чем за max_time минут, по возрастанию времени;
+    // ограниченный поиск из одной остановки, таблица всех пар для него не нужна
+    std::vector<ReachableStop> BuildReachableStops(std::string_view stop_from, double max_time) const;
+    // Пути, оптимальные по Парето по времени и числу посадок, по возрастанию числа посадок;
+    // их ищет только RAPTOR, остальные движки возвращают лишь самый быстрый путь
+    std::vector<PathInfo> BuildParetoPaths(std::string_view stop_from, std::string_view stop_to) const;
+    // false — где-то дорога короче прямой и оценка A* уменьшена; в снимке хранится сам коэффициент
+    bool IsHeuristicAdmissible() const;
+    // Сколько параллельных рёбер удалено при сжатии графа
+    size_t GetRemovedParallelEdgeCount() const;
+    
+    // Граф, данные рёбер и таблицы маршрутизатора во версионированном бинарном снимке;
+    // после загрузки имена и таблица всех пар читаются прямо из отображённых в память страниц
+    // Снимок помнит отпечаток каталога и загружается только с тем же каталогом, иначе — исключение
+    void SaveSnapshot(const transport::TransportCatalogue& ctlg, const std::filesystem::path& path) const;
+    void LoadSnapshot(const transport::TransportCatalogue& ctlg, const std::filesystem::path& path);
  
 private:
     void AddVertexIdsInGraphData(const std::unordered_map<std::string_view, const Stop*>& all_stops);
+    void MapStopIdsToVertexIds(const transport::TransportCatalogue& ctlg);
+    std::unique_ptr<graph::RoutingEngine<RouteWeight>> MakeRoutingEngine() const;
+    double ComputeHeuristicScale(const transport::TransportCatalogue& ctlg) const;
+    graph::AStarRouter<RouteWeight>::Heuristic MakeGeoHeuristic() const;
+    // Рёбра одного автобуса до добавления в граф. Автобусы обрабатываются независимо,
+    // а их рёбра дописываются в граф по порядку номеров автобусов, так что EdgeId
+    // не зависят от числа потоков
+    struct RouteEdges {
+        std::vector<graph::Edge<RouteWeight>> edges;
+        EdgesTransportData edges_data;
+    };
+
+    void AddRouteEdgesInGraph(const transport::TransportCatalogue& ctlg, const Route& route, uint32_t bus_id);
+    void AddRouteEdgesInGraph(RouteEdges& route_edges, uint32_t bus_id);
+    void BuildRouteEdges(const transport::TransportCatalogue& ctlg, const Route& route, uint32_t bus_id,
+                         graph::VertexId first_route_stop_vertex_id, RouteEdges& route_edges);
+    void BuildRouteDirectionEdges(const std::vector<graph::VertexId>& stop_ids, const std::vector<int>& distances,
+                                  uint32_t bus_id, RouteEdges& route_edges) const;
+    void BuildRouteStopsDirectionEdges(const std::vector<graph::VertexId>& stop_ids, const std::vector<int>& distances,
+                                       uint32_t bus_id, graph::VertexId first_route_stop_vertex_id, RouteEdges& route_edges);
+    void AddRouteInRaptorRoutes(const transport::TransportCatalogue& ctlg, const Route& route, uint32_t bus_id,
+                                RaptorRoutes& raptor_routes);
+    Raptor<RouteWeight>::LegWeight MakeRaptorLegWeight() const;
+    void FillRaptorPathInfo(const std::vector<Raptor<RouteWeight>::Leg>& legs, RouteWeight weight, PathInfo& path_info) const;
+    void UpdateRoutes(const transport::TransportCatalogue& ctlg, const std::vector<std::string_view>& route_names);
+    bool IsRebuiltOnUpdate() const;
+    bool ReplaceRouteEdges(const transport::TransportCatalogue& ctlg, std::string_view route_name,
+                           std::vector<graph::EdgeId>& added_edges, std::vector<graph::EdgeId>& removed_edges);
+    void ApplyEdgesUpdate(const transport::TransportCatalogue& ctlg, const std::vector<graph::EdgeId>& added_edges, 
+                          const std::vector<graph::EdgeId>& removed_edges);
+    static void AddEdgeInRouteEdges(RouteEdges& route_edges, const graph::Edge<RouteWeight>& edge, uint32_t bus_id, int span_count,
+                                    graph::VertexId start_stop_id, graph::VertexId finish_stop_id, EdgeType type = EdgeType::BUS);
+    EdgeInfo GetEdgeInfo(graph::EdgeId edge_id) const;
+    size_t CountRouteStopVertices(const transport::TransportCatalogue& ctlg) const;
+    size_t CountRouteEdges(const Route& route) const;
 
     template <typename RandomIt>
-    void AddRouteInGraph(const transport::TransportCatalogue& ctlg, RandomIt vec_stops_start_it, size_t vec_stops_size, std::string_view route_name) {
-        const int meters_in_km = 1000;
-        const int seconds_in_min = 60;
-        for (size_t index_stop_from = 0; index_stop_from < vec_stops_size; ++index_stop_from) { 
-            uint32_t total_distance = 0;
-            for (size_t index_stop_to = index_stop_from + 1; index_stop_to < vec_stops_size; ++index_stop_to) {
-                auto pos_stop_from = vec_stops_start_it + index_stop_from;
-                auto pos_stop_before_to = vec_stops_start_it + index_stop_to - 1;
-                auto pos_stop_to = vec_stops_start_it + index_stop_to;
-
-                const graph::VertexId id_stop_from = graph_data_.vertex_id_by_stop_name[*pos_stop_from];
-                const graph::VertexId id_stop_to = graph_data_.vertex_id_by_stop_name[*pos_stop_to];                
-                total_distance += ctlg.GetDistance(*pos_stop_before_to, *pos_stop_to); 
-
-                const double weight = ((total_distance * seconds_in_min) / 
-                                      (meters_in_km * routing_settings_.bus_velocity)) + routing_settings_.bus_wait_time;
-                graph_data_.graph.AddEdge({id_stop_from, id_stop_to, weight});
-
-                const int span_count = index_stop_to - index_stop_from;
-                graph_data_.edge_info_by_edge_id[graph_data_.graph.GetEdgeCount() - 1] = 
-                {weight - routing_settings_.bus_wait_time, route_name, span_count, *pos_stop_from, *pos_stop_to};
-            } 
-        }  
-    }    
+    void AddRouteDirectionInRaptorRoutes(const transport::TransportCatalogue& ctlg, RandomIt vec_stops_start_it, 
+                                         size_t vec_stops_size, uint32_t bus_id, RaptorRoutes& raptor_routes) {
+        uint64_t total_distance = 0;
+        for (size_t index_stop = 0; index_stop < vec_stops_size; ++index_stop) {
+            auto pos_stop = vec_stops_start_it + index_stop;
+            if (index_stop > 0) {
+                total_distance += ctlg.GetDistance(*(pos_stop - 1), *pos_stop);
+            }
+            raptor_routes.stops.push_back(vertex_id_by_stop_id_.at(*pos_stop));
+            raptor_routes.distances.push_back(total_distance);
+        }
+        raptor_routes.offsets.push_back(raptor_routes.stops.size());
+        bus_id_by_raptor_route_.push_back(bus_id);
+    }
+
+    static constexpr graph::VertexId NO_VERTEX = std::numeric_limits<graph::VertexId>::max();
+    static constexpr size_t ROUTE_EDGES_BATCH_LIMIT = size_t{1} << 18;
 
     RoutingSettings routing_settings_;
-    GraphAndItsTransportData<double> graph_data_;
-    std::unique_ptr<graph::Router<double>> router_;          
+    GraphAndItsTransportData<RouteWeight> graph_data_;
+    graph::ReachabilitySearch<RouteWeight> reachability_search_{graph_data_.graph};
+    graph::VertexId next_route_stop_vertex_id_ = 0;
+    // Вершина остановки по её номеру в каталоге, NO_VERTEX — остановки нет в графе
+    std::vector<graph::VertexId> vertex_id_by_stop_id_;
+    double heuristic_scale_ = 1.0;
+    size_t removed_parallel_edge_count_ = 0;
+    // Рёбра и вершины «маршрут–остановка» прежних версий маршрутов, оставшиеся в графе
+    size_t dead_edge_count_ = 0;
+    size_t dead_vertex_count_ = 0;
+    std::unique_ptr<MappedFile> snapshot_;
+    std::unique_ptr<graph::RoutingEngine<RouteWeight>> router_;          
+    // С RAPTOR граф без рёбер, а пути ищутся прямо по последовательностям остановок маршрутов
+    std::unique_ptr<Raptor<RouteWeight>> raptor_;
+    std::vector<uint32_t> bus_id_by_raptor_route_;
 };
     
 } // namespace transport